@@ -0,0 +1,135 @@
+import 'dart:typed_data';
+
+import 'package:fl_chart/fl_chart.dart';
+import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
+
+import 'telemetry.dart';
+
+// History queries against the runner's tiered time-series store
+// (linux/runner/telemetry_store.h). The store picks the rollup tier
+// and downsamples to at most `points` buckets, so any span comes back
+// as a chart-sized series.
+const MethodChannel _storeChannel = MethodChannel('gripmate/store');
+
+class TelemetryHistory {
+  TelemetryHistory(this.tier, this.time, this.min, this.max, this.mean);
+
+  final int tier;
+  final Float64List time; // Unix seconds at each bucket start
+  final Float32List min;
+  final Float32List max;
+  final Float32List mean;
+
+  int get length => time.length;
+}
+
+Future<TelemetryHistory?> queryHistory(
+  String channel,
+  DateTime from,
+  DateTime to, {
+  int points = 1000,
+}) async {
+  assert(channelNames.contains(channel));
+  try {
+    final result = await _storeChannel.invokeMapMethod<String, Object?>('query', {
+      'channel': channel,
+      'from': from.millisecondsSinceEpoch / 1000.0,
+      'to': to.millisecondsSinceEpoch / 1000.0,
+      'points': points,
+    });
+    if (result == null) return null;
+    return TelemetryHistory(
+      result['tier'] as int,
+      result['time'] as Float64List,
+      result['min'] as Float32List,
+      result['max'] as Float32List,
+      result['mean'] as Float32List,
+    );
+  } on MissingPluginException {
+    return null; // no native store on this platform
+  }
+}
+
+// Line chart of one channel's bucket means over the last `span`.
+class HistoryChart extends StatefulWidget {
+  const HistoryChart({
+    super.key,
+    required this.channel,
+    required this.span,
+    this.points = 600,
+    this.height = 200,
+    this.color = Colors.blue,
+  });
+
+  final String channel;
+  final Duration span;
+  final int points;
+  final double height;
+  final Color color;
+
+  @override
+  State<HistoryChart> createState() => _HistoryChartState();
+}
+
+class _HistoryChartState extends State<HistoryChart> {
+  late Future<TelemetryHistory?> _history;
+
+  @override
+  void initState() {
+    super.initState();
+    final now = DateTime.now();
+    _history = queryHistory(
+      widget.channel,
+      now.subtract(widget.span),
+      now,
+      points: widget.points,
+    );
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return Container(
+      height: widget.height,
+      padding: const EdgeInsets.all(8),
+      decoration: BoxDecoration(
+        color: Colors.grey.shade100,
+        borderRadius: BorderRadius.circular(12),
+      ),
+      child: FutureBuilder<TelemetryHistory?>(
+        future: _history,
+        builder: (context, snapshot) {
+          final history = snapshot.data;
+          if (snapshot.connectionState != ConnectionState.done) {
+            return const Center(child: CircularProgressIndicator());
+          }
+          if (history == null || history.length == 0) {
+            return const Center(
+              child: Text('No history yet', style: TextStyle(color: Colors.grey)),
+            );
+          }
+          final t0 = history.time.first;
+          final spots = [
+            for (var i = 0; i < history.length; i++)
+              FlSpot((history.time[i] - t0) / 3600, history.mean[i]),
+          ];
+          return LineChart(
+            LineChartData(
+              lineBarsData: [
+                LineChartBarData(
+                  spots: spots,
+                  colors: [widget.color],
+                  barWidth: 1.5,
+                  dotData: FlDotData(show: false),
+                ),
+              ],
+              titlesData: FlTitlesData(show: false),
+              gridData: FlGridData(show: false),
+              borderData: FlBorderData(show: false),
+            ),
+          );
+        },
+      ),
+    );
+  }
+}
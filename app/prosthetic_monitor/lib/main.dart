@@ -1,5 +1,8 @@
 import 'package:flutter/material.dart';
 
+import 'history.dart';
+import 'telemetry.dart';
+
 final GlobalKey<NavigatorState> navigatorKey = GlobalKey<NavigatorState>();
 
 void main() {
@@ -170,23 +173,11 @@ class UsageAnalyticsScreen extends StatelessWidget {
 
             const SizedBox(height: 24),
             const Text(
-              'Weekly Usage Pattern',
+              'Grip Activity (30 days)',
               style: TextStyle(fontSize: 18, fontWeight: FontWeight.bold),
             ),
             const SizedBox(height: 16),
-            Container(
-              height: 200,
-              decoration: BoxDecoration(
-                color: Colors.grey.shade100,
-                borderRadius: BorderRadius.circular(12),
-              ),
-              child: const Center(
-                child: Text(
-                  'Usage Chart Visualization',
-                  style: TextStyle(color: Colors.grey),
-                ),
-              ),
-            ),
+            const HistoryChart(channel: 'muscle', span: Duration(days: 30)),
 
             const SizedBox(height: 24),
             const Text(
@@ -314,6 +305,26 @@ class HealthMonitoringScreen extends StatelessWidget {
               ),
             ),
 
+            const SizedBox(height: 24),
+            const Text(
+              'Live EMG',
+              style: TextStyle(fontSize: 18, fontWeight: FontWeight.bold),
+            ),
+            const SizedBox(height: 16),
+            const LiveEmgChart(),
+
+            const SizedBox(height: 24),
+            const Text(
+              'EMG Level (24 hours)',
+              style: TextStyle(fontSize: 18, fontWeight: FontWeight.bold),
+            ),
+            const SizedBox(height: 16),
+            const HistoryChart(
+              channel: 'rms',
+              span: Duration(hours: 24),
+              color: Colors.green,
+            ),
+
             const SizedBox(height: 24),
             const Text(
               'Battery Status',
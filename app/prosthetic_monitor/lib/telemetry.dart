@@ -0,0 +1,244 @@
+import 'dart:async';
+import 'dart:typed_data';
+
+import 'package:flutter/material.dart';
+import 'package:flutter/services.dart';
+
+// Live telemetry from the native ingest (linux/runner/telemetry_ingest.h).
+// Each event is one Float32List: an 8-word header, then `capacity`
+// floats per column. Column 0 is time in seconds relative to the
+// float64 base in header words 6..7; the rest follow channelNames.
+// Keep both layouts in sync with the runner.
+const EventChannel _telemetryChannel = EventChannel('gripmate/telemetry');
+
+const List<String> channelNames = ['rms', 'threshold', 'muscle', 'angle', 'state', 'current'];
+const int _batchFormatVersion = 2;
+const int _headerWords = 8;
+
+class TelemetryBatch {
+  TelemetryBatch._(
+      this._data, this.rows, this.capacity, this.dropped, this.frames, this.timeBase);
+
+  final Float32List _data;
+  final int rows;
+  final int capacity;
+  final int dropped;
+  final int frames;
+  // Seconds since the stream started; add to time[i]
+  final double timeBase;
+
+  // Views into the received buffer; nothing is copied.
+  Float32List get time => column(0);
+  Float32List channel(String name) => column(channelNames.indexOf(name) + 1);
+
+  Float32List column(int c) => Float32List.sublistView(
+      _data, _headerWords + c * capacity, _headerWords + c * capacity + rows);
+
+  static TelemetryBatch? parse(Object? event) {
+    if (event is! Float32List || event.length < _headerWords) return null;
+    if (event[0].toInt() != _batchFormatVersion) return null;
+    final columns = event[1].toInt();
+    final capacity = event[2].toInt();
+    final rows = event[3].toInt();
+    if (columns != channelNames.length + 1 ||
+        rows > capacity ||
+        event.length < _headerWords + columns * capacity) {
+      return null;
+    }
+    final timeBase = ByteData.sublistView(event, 6, 8).getFloat64(0, Endian.host);
+    return TelemetryBatch._(
+        event, rows, capacity, event[4].toInt(), event[5].toInt(), timeBase);
+  }
+}
+
+// Source is a serial device, pty path or "tcp://host:port"; null uses
+// GRIPMATE_TELEMETRY. Only the Linux runner implements the channel.
+Stream<TelemetryBatch> telemetryBatches({String? source}) {
+  return _telemetryChannel
+      .receiveBroadcastStream(source)
+      .map(TelemetryBatch.parse)
+      .where((b) => b != null)
+      .cast<TelemetryBatch>();
+}
+
+// Scrolling plot of the RMS envelope and threshold, with the muscle
+// state shaded underneath.
+class LiveEmgChart extends StatefulWidget {
+  const LiveEmgChart({super.key, this.source, this.windowSeconds = 5, this.height = 180});
+
+  final String? source;
+  final double windowSeconds;
+  final double height;
+
+  @override
+  State<LiveEmgChart> createState() => _LiveEmgChartState();
+}
+
+class _LiveEmgChartState extends State<LiveEmgChart> {
+  // Ring buffer; 250 decimated buckets/s, two rows each at most
+  static const int _ringSize = 4096;
+  final Float64List _t = Float64List(_ringSize);
+  final Float32List _rms = Float32List(_ringSize);
+  final Float32List _threshold = Float32List(_ringSize);
+  final Float32List _muscle = Float32List(_ringSize);
+  int _head = 0;
+  int _count = 0;
+  int _dropped = 0;
+  int _revision = 0;
+
+  // Y range in volts: grows at once to fit a new peak, then decays
+  // towards the window's peak, so a ~50 mV trace still fills the plot
+  static const double _yFloor = 0.005;
+  static const double _yDecay = 0.02; // per batch, ~1 s at 60 batches/s
+  double _yMax = _yFloor;
+
+  StreamSubscription<TelemetryBatch>? _subscription;
+  String? _error;
+
+  @override
+  void initState() {
+    super.initState();
+    _subscription = telemetryBatches(source: widget.source).listen(
+      _onBatch,
+      onError: (Object e) {
+        setState(() => _error = e is PlatformException ? e.message : '$e');
+      },
+    );
+  }
+
+  @override
+  void dispose() {
+    _subscription?.cancel();
+    super.dispose();
+  }
+
+  void _onBatch(TelemetryBatch batch) {
+    final t = batch.time;
+    final rms = batch.channel('rms');
+    final threshold = batch.channel('threshold');
+    final muscle = batch.channel('muscle');
+    for (var i = 0; i < batch.rows; i++) {
+      _t[_head] = batch.timeBase + t[i];
+      _rms[_head] = rms[i];
+      _threshold[_head] = threshold[i];
+      _muscle[_head] = muscle[i];
+      _head = (_head + 1) % _ringSize;
+      if (_count < _ringSize) _count++;
+    }
+    setState(() {
+      _dropped += batch.dropped;
+      _revision++;
+      _error = null;
+      _updateRange();
+    });
+  }
+
+  void _updateRange() {
+    final last = (_head - 1 + _ringSize) % _ringSize;
+    final tStart = _t[last] - widget.windowSeconds;
+    var peak = _yFloor;
+    for (var k = 0; k < _count; k++) {
+      final i = (_head - _count + k + _ringSize) % _ringSize;
+      if (_t[i] < tStart) continue;
+      if (_rms[i] > peak) peak = _rms[i];
+      if (_threshold[i] > peak) peak = _threshold[i];
+    }
+    peak *= 1.1;
+    _yMax = peak > _yMax ? peak : _yMax + (peak - _yMax) * _yDecay;
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    if (_error != null || _count == 0) {
+      return Container(
+        height: widget.height,
+        alignment: Alignment.center,
+        decoration: BoxDecoration(
+          color: Colors.grey.shade100,
+          borderRadius: BorderRadius.circular(12),
+        ),
+        child: Text(
+          _error ?? 'Waiting for telemetry…',
+          style: TextStyle(color: Colors.grey.shade600),
+        ),
+      );
+    }
+    return Column(
+      crossAxisAlignment: CrossAxisAlignment.end,
+      children: [
+        SizedBox(
+          height: widget.height,
+          width: double.infinity,
+          child: CustomPaint(
+            painter: _EmgPainter(this, _revision),
+          ),
+        ),
+        if (_dropped > 0)
+          Text(
+            '$_dropped batches dropped',
+            style: TextStyle(fontSize: 12, color: Colors.orange.shade700),
+          ),
+      ],
+    );
+  }
+}
+
+class _EmgPainter extends CustomPainter {
+  _EmgPainter(this.state, this.revision);
+
+  final _LiveEmgChartState state;
+  final int revision;
+
+  @override
+  void paint(Canvas canvas, Size size) {
+    final s = state;
+    if (s._count < 2) return;
+    final size0 = _LiveEmgChartState._ringSize;
+    final first = (s._head - s._count + size0) % size0;
+    final last = (s._head - 1 + size0) % size0;
+    final tEnd = s._t[last];
+    final tStart = tEnd - state.widget.windowSeconds;
+
+    final yMax = s._yMax;
+
+    double x(double t) => (t - tStart) / state.widget.windowSeconds * size.width;
+    double y(double v) => size.height - v / yMax * size.height;
+
+    final rms = Path();
+    final threshold = Path();
+    final active = Paint()..color = Colors.green.withOpacity(0.15);
+    var started = false;
+    for (var k = 0; k < s._count; k++) {
+      final i = (first + k) % size0;
+      if (s._t[i] < tStart) continue;
+      final px = x(s._t[i]);
+      if (!started) {
+        rms.moveTo(px, y(s._rms[i]));
+        threshold.moveTo(px, y(s._threshold[i]));
+        started = true;
+      } else {
+        rms.lineTo(px, y(s._rms[i]));
+        threshold.lineTo(px, y(s._threshold[i]));
+      }
+      if (s._muscle[i] > 0.5) {
+        canvas.drawRect(Rect.fromLTRB(px, 0, px + 2, size.height), active);
+      }
+    }
+
+    canvas.drawPath(
+        threshold,
+        Paint()
+          ..color = Colors.orange
+          ..style = PaintingStyle.stroke
+          ..strokeWidth = 1);
+    canvas.drawPath(
+        rms,
+        Paint()
+          ..color = Colors.blue.shade700
+          ..style = PaintingStyle.stroke
+          ..strokeWidth = 1.5);
+  }
+
+  @override
+  bool shouldRepaint(_EmgPainter old) => old.revision != revision;
+}
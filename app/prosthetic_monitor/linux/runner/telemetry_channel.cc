@@ -0,0 +1,232 @@
+#include "telemetry_channel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "telemetry_ingest.h"
+#include "telemetry_store.h"
+
+// Standard codec type tag for Float32List.
+static constexpr uint8_t kStandardFloat32List = 14;
+
+struct TelemetryChannel {
+  FlBinaryMessenger* messenger;
+  FlEventChannel* channel;
+  FlMethodChannel* store_channel;
+  TelemetryStore store;
+  TelemetryIngest ingest;
+  size_t prefix;
+  // Bumped per listen so batches from a cancelled stream are discarded
+  unsigned generation;
+};
+
+struct PendingBatch {
+  TelemetryChannel* self;
+  unsigned generation;
+  uint8_t* payload;
+  size_t size;
+};
+
+// Writes the StandardMethodCodec success envelope for a Float32List of
+// `count` elements in front of the float area, so the batch goes out
+// without re-encoding. Returns the envelope size (a multiple of 4, as
+// the codec aligns float data); a zero `out` only measures.
+static size_t write_envelope(uint8_t* out, size_t count) {
+  uint8_t header[8];
+  size_t n = 0;
+  header[n++] = 0;  // success
+  header[n++] = kStandardFloat32List;
+  if (count < 254) {
+    header[n++] = static_cast<uint8_t>(count);
+  } else if (count <= 0xffff) {
+    header[n++] = 254;
+    header[n++] = static_cast<uint8_t>(count);
+    header[n++] = static_cast<uint8_t>(count >> 8);
+  } else {
+    header[n++] = 255;
+    for (int i = 0; i < 4; i++) header[n++] = static_cast<uint8_t>(count >> (8 * i));
+  }
+  size_t padded = (n + 3) & ~static_cast<size_t>(3);
+  if (out) {
+    memset(out, 0, padded);
+    memcpy(out, header, n);
+  }
+  return padded;
+}
+
+// Runs on the platform thread.
+static gboolean send_batch(gpointer user_data) {
+  PendingBatch* batch = static_cast<PendingBatch*>(user_data);
+  TelemetryChannel* self = batch->self;
+  if (batch->generation == self->generation) {
+    write_envelope(batch->payload, (batch->size - self->prefix) / sizeof(float));
+    g_autoptr(GBytes) bytes =
+        g_bytes_new_with_free_func(batch->payload, batch->size, free, batch->payload);
+    fl_binary_messenger_send_on_channel(self->messenger, TELEMETRY_CHANNEL_NAME,
+                                        bytes, nullptr, nullptr, nullptr);
+    self->ingest.BatchConsumed();
+  } else {
+    // From a cancelled stream; its ingest counter was reset on restart
+    free(batch->payload);
+  }
+  delete batch;
+  return G_SOURCE_REMOVE;
+}
+
+static FlMethodErrorResponse* listen_cb(FlEventChannel* channel, FlValue* args,
+                                        gpointer user_data) {
+  TelemetryChannel* self = static_cast<TelemetryChannel*>(user_data);
+  const char* uri = nullptr;
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_STRING) {
+    uri = fl_value_get_string(args);
+  }
+  if (uri == nullptr || *uri == '\0') uri = g_getenv("GRIPMATE_TELEMETRY");
+  if (uri == nullptr || *uri == '\0') {
+    return fl_method_error_response_new(
+        "no_source", "No telemetry source given and GRIPMATE_TELEMETRY unset",
+        nullptr);
+  }
+
+  unsigned generation = ++self->generation;
+  bool started = self->ingest.Start(
+      uri, self->prefix, [self, generation](uint8_t* payload, size_t size) {
+        g_main_context_invoke(nullptr, send_batch,
+                              new PendingBatch{self, generation, payload, size});
+        return true;
+      });
+  if (!started) {
+    return fl_method_error_response_new("start_failed",
+                                        "Could not start telemetry ingest", nullptr);
+  }
+  return nullptr;
+}
+
+static FlMethodErrorResponse* cancel_cb(FlEventChannel* channel, FlValue* args,
+                                        gpointer user_data) {
+  TelemetryChannel* self = static_cast<TelemetryChannel*>(user_data);
+  // Batches already queued to the main loop are freed by send_batch.
+  self->generation++;
+  self->ingest.Stop();
+  return nullptr;
+}
+
+static int channel_index(FlValue* value) {
+  if (value == nullptr) return -1;
+  if (fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    return static_cast<int>(fl_value_get_int(value));
+  }
+  if (fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+    for (int i = 0; i < kTelemetryChannels; i++) {
+      if (strcmp(fl_value_get_string(value), kTelemetryChannelNames[i]) == 0) return i;
+    }
+  }
+  return -1;
+}
+
+static double number_arg(FlValue* args, const char* key, double fallback) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr) return fallback;
+  switch (fl_value_get_type(value)) {
+    case FL_VALUE_TYPE_INT:
+      return static_cast<double>(fl_value_get_int(value));
+    case FL_VALUE_TYPE_FLOAT:
+      return fl_value_get_float(value);
+    default:
+      return fallback;
+  }
+}
+
+// "query" {channel, from, to, points} -> {tier, time, min, max, mean}
+// with Unix-second times; "diskUsage" -> bytes per tier.
+static FlMethodResponse* handle_store_call(TelemetryChannel* self,
+                                           FlMethodCall* method_call) {
+  const gchar* method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  if (strcmp(method, "query") == 0) {
+    if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+      return FL_METHOD_RESPONSE(
+          fl_method_error_response_new("bad_args", "Expected a map", nullptr));
+    }
+    int channel = channel_index(fl_value_lookup_string(args, "channel"));
+    double from = number_arg(args, "from", 0);
+    double to = number_arg(args, "to", 0);
+    // Clamped as a double: a huge or NaN count must not reach the cast
+    double requested = number_arg(args, "points", 1000);
+    int points = requested >= 1
+                     ? static_cast<int>(std::min(requested, static_cast<double>(kMaxQueryPoints)))
+                     : 0;
+    TelemetrySeries series;
+    if (!self->store.Query(channel, from, to, points, &series)) {
+      return FL_METHOD_RESPONSE(
+          fl_method_error_response_new("bad_query", "Invalid channel or range", nullptr));
+    }
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "tier", fl_value_new_int(series.tier));
+    fl_value_set_string_take(result, "time",
+                             fl_value_new_float_list(series.time.data(), series.time.size()));
+    fl_value_set_string_take(result, "min",
+                             fl_value_new_float32_list(series.min.data(), series.min.size()));
+    fl_value_set_string_take(result, "max",
+                             fl_value_new_float32_list(series.max.data(), series.max.size()));
+    fl_value_set_string_take(result, "mean",
+                             fl_value_new_float32_list(series.mean.data(), series.mean.size()));
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  if (strcmp(method, "diskUsage") == 0) {
+    int64_t bytes[kTierCount];
+    for (int k = 0; k < kTierCount; k++) bytes[k] = self->store.DiskBytes(k);
+    g_autoptr(FlValue) result = fl_value_new_int64_list(bytes, kTierCount);
+    return FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  }
+
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+static void store_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                          gpointer user_data) {
+  TelemetryChannel* self = static_cast<TelemetryChannel*>(user_data);
+  g_autoptr(FlMethodResponse) response = handle_store_call(self, method_call);
+  fl_method_call_respond(method_call, response, nullptr);
+}
+
+static TelemetryChannel* telemetry_channel = nullptr;
+
+void telemetry_channel_shutdown() {
+  if (telemetry_channel == nullptr) return;
+  telemetry_channel->generation++;
+  telemetry_channel->ingest.Stop();
+  telemetry_channel->store.Close();
+}
+
+void telemetry_channel_register(FlPluginRegistry* registry) {
+  g_autoptr(FlPluginRegistrar) registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "TelemetryChannel");
+  // Lives as long as the application; queued batches reference it.
+  TelemetryChannel* self = new TelemetryChannel();
+  self->messenger = fl_plugin_registrar_get_messenger(registrar);
+  g_object_ref(self->messenger);
+  self->prefix = write_envelope(
+      nullptr, kBatchHeaderWords + static_cast<size_t>(kBatchColumns) * kBatchCapacity);
+
+  g_autofree gchar* store_dir =
+      g_build_filename(g_get_user_data_dir(), "gripmate", "telemetry", nullptr);
+  if (g_mkdir_with_parents(store_dir, 0755) == 0 && self->store.Open(store_dir)) {
+    self->ingest.set_store(&self->store);
+  } else {
+    g_warning("Telemetry history disabled: cannot open %s", store_dir);
+  }
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  self->channel = fl_event_channel_new(self->messenger, TELEMETRY_CHANNEL_NAME,
+                                       FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(self->channel, listen_cb, cancel_cb, self,
+                                       nullptr);
+  self->store_channel = fl_method_channel_new(self->messenger, TELEMETRY_STORE_CHANNEL_NAME,
+                                              FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(self->store_channel, store_call_cb, self,
+                                            nullptr);
+  telemetry_channel = self;
+}
@@ -0,0 +1,33 @@
+#ifndef RUNNER_TELEMETRY_CHANNEL_H_
+#define RUNNER_TELEMETRY_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Name of the event channel carrying live telemetry batches.
+#define TELEMETRY_CHANNEL_NAME "gripmate/telemetry"
+// Name of the method channel answering history queries.
+#define TELEMETRY_STORE_CHANNEL_NAME "gripmate/store"
+
+/**
+ * telemetry_channel_register:
+ * @registry: the view's plugin registry.
+ *
+ * Registers the live telemetry event channel. Listening with a device
+ * path or "tcp://host:port" argument (or none, to use the
+ * GRIPMATE_TELEMETRY environment variable) starts native ingest; each
+ * event is a Float32List batch laid out as in telemetry_ingest.h.
+ *
+ * Ingested telemetry is also recorded into the history store under the
+ * user data directory, queried over TELEMETRY_STORE_CHANNEL_NAME.
+ */
+void telemetry_channel_register(FlPluginRegistry* registry);
+
+/**
+ * telemetry_channel_shutdown:
+ *
+ * Stops ingest and closes the history store, writing out the partial
+ * rollup buckets. Call once at application shutdown.
+ */
+void telemetry_channel_shutdown();
+
+#endif  // RUNNER_TELEMETRY_CHANNEL_H_
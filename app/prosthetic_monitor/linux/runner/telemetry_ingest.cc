@@ -0,0 +1,360 @@
+#include "telemetry_ingest.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "telemetry_store.h"
+
+const char* const kTelemetryChannelNames[kTelemetryChannels] = {
+    "rms", "threshold", "muscle", "angle", "state", "current"};
+
+namespace {
+
+// Min/max bucket width: 250 buckets/s keeps every spike of a 1 kHz
+// stream while bounding what Dart has to draw.
+constexpr double kBucketSeconds = 0.004;
+// One batch per display frame.
+constexpr double kFlushSeconds = 1.0 / 60.0;
+// Batches handed to the platform thread but not yet sent.
+constexpr int kMaxInFlight = 4;
+constexpr int kReconnectMs = 1000;
+
+double NowSeconds() {
+  using Clock = std::chrono::steady_clock;
+  return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+double WallSeconds() {
+  using Clock = std::chrono::system_clock;
+  return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+enum Extreme { kValue, kMin, kMax };
+
+// Channel of ">name", ">name_min" or ">name_max"; -1 if not one of ours
+int ChannelIndex(const char* name, size_t len, Extreme* extreme) {
+  *extreme = kValue;
+  if (len > 4 && memcmp(name + len - 4, "_min", 4) == 0) {
+    *extreme = kMin;
+    len -= 4;
+  } else if (len > 4 && memcmp(name + len - 4, "_max", 4) == 0) {
+    *extreme = kMax;
+    len -= 4;
+  }
+  for (int i = 0; i < kTelemetryChannels; i++) {
+    if (strlen(kTelemetryChannelNames[i]) == len &&
+        strncmp(kTelemetryChannelNames[i], name, len) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+// TelemetryParser ------------------------------------------------------------
+
+TelemetryParser::TelemetryParser(size_t prefix, int capacity,
+                                 double bucket_seconds, BatchCallback on_batch)
+    : prefix_(prefix),
+      capacity_(capacity),
+      bucket_seconds_(bucket_seconds),
+      on_batch_(std::move(on_batch)) {
+  NewBatch();
+}
+
+TelemetryParser::~TelemetryParser() { free(batch_); }
+
+// On allocation failure the rows of this batch are counted but not
+// stored, and the batch is dropped when it would have been emitted.
+void TelemetryParser::NewBatch() {
+  size_t words = kBatchHeaderWords + static_cast<size_t>(kBatchColumns) * capacity_;
+  batch_ = static_cast<uint8_t*>(calloc(1, prefix_ + words * sizeof(float)));
+  words_ = batch_ ? reinterpret_cast<float*>(batch_ + prefix_) : nullptr;
+  rows_ = 0;
+  frames_ = 0;
+}
+
+void TelemetryParser::Feed(const char* data, size_t len, double now) {
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+    if (c == '\n' || c == '\r') {
+      if (line_len_ > 0) ParseLine(line_, line_len_, now);
+      line_len_ = 0;
+    } else if (line_len_ < sizeof(line_) - 1) {
+      line_[line_len_++] = c;
+    }
+  }
+}
+
+void TelemetryParser::ParseLine(const char* line, size_t len, double now) {
+  lines_++;
+  // Only ">name:value" telemetry; ">> ..." lines are state-machine logs
+  if (len < 4 || line[0] != '>' || line[1] == '>') return;
+
+  const char* name = line + 1;
+  const char* colon = static_cast<const char*>(memchr(name, ':', len - 1));
+  if (!colon) return;
+  Extreme extreme;
+  int ch = ChannelIndex(name, colon - name, &extreme);
+  if (ch < 0) return;
+
+  char text[64];
+  size_t n = len - (colon + 1 - line);
+  if (n >= sizeof(text)) return;
+  memcpy(text, colon + 1, n);
+  text[n] = '\0';
+
+  // Optional Teleplot timestamp: ">name:ms:value"
+  double t = now;
+  char* value = text;
+  char* second = strchr(text, ':');
+  if (second) {
+    *second = '\0';
+    t = strtod(text, nullptr) / 1000.0;
+    value = second + 1;
+  }
+  char* end = nullptr;
+  float v = strtof(value, &end);
+  if (end == value) return;
+
+  unsigned bit = 1u << ch;
+  if (extreme != kValue) {
+    // Follows its channel's value in the same frame
+    if (!(frame_mask_ & bit)) return;
+    if (extreme == kMin) frame_min_[ch] = v;
+    else frame_max_[ch] = v;
+    extreme_mask_ |= bit;
+    return;
+  }
+  // A repeated channel starts the next frame. A complete frame is not
+  // closed early: its last channel's _min/_max may still follow.
+  if (frame_mask_ & bit) CloseFrame();
+  if (frame_mask_ == 0) frame_time_ = t;
+  frame_[ch] = frame_min_[ch] = frame_max_[ch] = v;
+  frame_mask_ |= bit;
+}
+
+void TelemetryParser::CloseFrame() {
+  if (frame_mask_ == 0) return;
+  frame_mask_ = 0;
+  frames_++;
+  // Channels not sent this frame hold their last value, not its extremes
+  for (int i = 0; i < kTelemetryChannels; i++) {
+    if (!(extreme_mask_ & (1u << i))) frame_min_[i] = frame_max_[i] = frame_[i];
+  }
+  extreme_mask_ = 0;
+  if (time_origin_ < 0) time_origin_ = frame_time_;
+  double t = frame_time_ - time_origin_;
+
+  if (bucket_open_ && t >= bucket_start_ + bucket_seconds_) CloseBucket();
+  if (!bucket_open_) {
+    bucket_open_ = true;
+    bucket_start_ = t;
+    bucket_frames_ = 0;
+    for (int i = 0; i < kTelemetryChannels; i++) {
+      min_[i] = frame_min_[i];
+      max_[i] = frame_max_[i];
+      min_time_[i] = max_time_[i] = t;
+    }
+  }
+  for (int i = 0; i < kTelemetryChannels; i++) {
+    if (frame_min_[i] < min_[i]) { min_[i] = frame_min_[i]; min_time_[i] = t; }
+    if (frame_max_[i] > max_[i]) { max_[i] = frame_max_[i]; max_time_[i] = t; }
+  }
+  bucket_frames_++;
+}
+
+// Emits one row for a single-frame bucket with no spread, otherwise two
+// rows carrying each channel's extremes in the order they occurred.
+void TelemetryParser::CloseBucket() {
+  if (!bucket_open_) return;
+  bucket_open_ = false;
+  if (bucket_frames_ == 1 && std::equal(min_, min_ + kTelemetryChannels, max_)) {
+    AppendRow(bucket_start_, min_);
+    return;
+  }
+  float first[kTelemetryChannels];
+  float second[kTelemetryChannels];
+  double last = bucket_start_;
+  for (int i = 0; i < kTelemetryChannels; i++) {
+    bool min_first = min_time_[i] <= max_time_[i];
+    first[i] = min_first ? min_[i] : max_[i];
+    second[i] = min_first ? max_[i] : min_[i];
+    if (min_time_[i] > last) last = min_time_[i];
+    if (max_time_[i] > last) last = max_time_[i];
+  }
+  AppendRow(bucket_start_, first);
+  AppendRow(last > bucket_start_ ? last : bucket_start_ + bucket_seconds_ / 2, second);
+}
+
+void TelemetryParser::AppendRow(double t, const float* values) {
+  if (words_) {
+    float* columns = words_ + kBatchHeaderWords;
+    if (rows_ == 0) time_base_ = t;
+    columns[rows_] = static_cast<float>(t - time_base_);
+    for (int i = 0; i < kTelemetryChannels; i++) {
+      columns[(i + 1) * capacity_ + rows_] = values[i];
+    }
+  }
+  if (++rows_ == capacity_) Flush();
+}
+
+void TelemetryParser::Flush() {
+  CloseBucket();
+  if (rows_ == 0) return;
+  if (!batch_) {
+    dropped_++;
+    NewBatch();
+    return;
+  }
+  words_[0] = kBatchFormatVersion;
+  words_[1] = kBatchColumns;
+  words_[2] = static_cast<float>(capacity_);
+  words_[3] = static_cast<float>(rows_);
+  words_[4] = static_cast<float>(dropped_);
+  words_[5] = static_cast<float>(frames_);
+  memcpy(&words_[6], &time_base_, sizeof(time_base_));
+  size_t size = prefix_ +
+      (kBatchHeaderWords + static_cast<size_t>(kBatchColumns) * capacity_) * sizeof(float);
+  uint8_t* payload = batch_;
+  batch_ = nullptr;
+  if (on_batch_(payload, size)) {
+    dropped_ = 0;
+  } else {
+    dropped_++;
+  }
+  NewBatch();
+}
+
+// TelemetryIngest ------------------------------------------------------------
+
+TelemetryIngest::~TelemetryIngest() { Stop(); }
+
+bool TelemetryIngest::Start(const std::string& uri, size_t prefix,
+                            TelemetryParser::BatchCallback on_batch) {
+  Stop();
+  if (pipe2(wake_, O_CLOEXEC | O_NONBLOCK) != 0) return false;
+  uri_ = uri;
+  prefix_ = prefix;
+  on_batch_ = std::move(on_batch);
+  stop_ = false;
+  in_flight_ = 0;
+  thread_ = std::thread(&TelemetryIngest::Run, this);
+  return true;
+}
+
+void TelemetryIngest::Stop() {
+  if (!thread_.joinable()) return;
+  stop_ = true;
+  ssize_t ignored = write(wake_[1], "x", 1);
+  (void)ignored;
+  thread_.join();
+  close(wake_[0]);
+  close(wake_[1]);
+  wake_[0] = wake_[1] = -1;
+}
+
+int TelemetryIngest::Open() {
+  if (uri_.compare(0, 6, "tcp://") == 0) {
+    std::string rest = uri_.substr(6);
+    size_t colon = rest.rfind(':');
+    if (colon == std::string::npos) return -1;
+    std::string host = rest.substr(0, colon);
+    std::string port = rest.substr(colon + 1);
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) return -1;
+    int fd = -1;
+    for (addrinfo* ai = res; ai && fd < 0; ai = ai->ai_next) {
+      fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+      if (fd < 0) continue;
+      timeval timeout = {2, 0};
+      setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+  }
+
+  // Serial device or pty slave
+  int fd = open(uri_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) return -1;
+  termios tio;
+  if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+void TelemetryIngest::Run() {
+  TelemetryParser parser(prefix_, kBatchCapacity, kBucketSeconds,
+                         [this](uint8_t* payload, size_t size) {
+                           if (store_) {
+                             store_->AppendBatch(
+                                 reinterpret_cast<const float*>(payload + prefix_),
+                                 WallSeconds());
+                           }
+                           // Platform thread is behind: drop rather than queue
+                           if (in_flight_ >= kMaxInFlight) {
+                             free(payload);
+                             return false;
+                           }
+                           in_flight_++;
+                           return on_batch_(payload, size);
+                         });
+
+  while (!stop_) {
+    int fd = Open();
+    if (fd < 0) {
+      pollfd wait = {wake_[0], POLLIN, 0};
+      poll(&wait, 1, kReconnectMs);
+      continue;
+    }
+
+    double last_flush = NowSeconds();
+    char buf[4096];
+    while (!stop_) {
+      pollfd fds[2] = {{fd, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+      int timeout_ms = static_cast<int>(kFlushSeconds * 1000) + 1;
+      if (poll(fds, 2, timeout_ms) < 0 && errno != EINTR) break;
+
+      if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n > 0) {
+          parser.Feed(buf, static_cast<size_t>(n), NowSeconds());
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+          break;  // device gone or peer closed: reconnect
+        }
+      }
+
+      double now = NowSeconds();
+      if (now - last_flush >= kFlushSeconds) {
+        parser.Flush();
+        last_flush = now;
+      }
+    }
+    close(fd);
+  }
+}
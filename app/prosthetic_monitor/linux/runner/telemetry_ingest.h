@@ -0,0 +1,141 @@
+#ifndef RUNNER_TELEMETRY_INGEST_H_
+#define RUNNER_TELEMETRY_INGEST_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Telemetry channels parsed from the firmware's Teleplot lines
+// (">name:value" or ">name:timestamp_ms:value"). A channel the firmware
+// decimates also sends ">name_min:" and ">name_max:" after its value;
+// those widen the bucket's extremes. Column 0 of every batch is time in
+// seconds; columns 1..kTelemetryChannels follow this order. Keep in
+// sync with lib/telemetry.dart.
+constexpr int kTelemetryChannels = 6;
+
+class TelemetryStore;
+extern const char* const kTelemetryChannelNames[kTelemetryChannels];
+
+// Batch payload layout, in float32 words:
+//   [0] format version   [1] columns (time + channels)
+//   [2] capacity         [3] rows
+//   [4] batches dropped since the last delivered one (refused by the
+//       sink, or no memory for them)
+//   [5] raw frames folded into this batch
+//   [6..7] float64 time base: seconds since the stream started
+// followed by one column of `capacity` floats per column, of which the
+// first `rows` are valid. Column 0 holds time relative to the base, so
+// long sessions keep sub-millisecond resolution.
+constexpr int kBatchFormatVersion = 2;
+constexpr int kBatchHeaderWords = 8;
+constexpr int kBatchColumns = kTelemetryChannels + 1;
+// Rows per column in batches from TelemetryIngest.
+constexpr int kBatchCapacity = 512;
+
+// Parses Teleplot text and decimates it into min/max buckets, writing
+// straight into a preallocated batch buffer. Not thread-safe; owned by
+// the ingest thread.
+class TelemetryParser {
+ public:
+  // Receives a payload of `size` bytes with `prefix` spare bytes in front
+  // of the float area (for the codec envelope). Ownership passes to the
+  // callback, which must release it with free(). Returns false if the
+  // batch was discarded; the next delivered batch reports the count.
+  using BatchCallback = std::function<bool(uint8_t* payload, size_t size)>;
+
+  TelemetryParser(size_t prefix, int capacity, double bucket_seconds,
+                  BatchCallback on_batch);
+  ~TelemetryParser();
+
+  // Feeds raw bytes received at host time `now` (seconds).
+  void Feed(const char* data, size_t len, double now);
+  // Emits the pending batch, if it has any rows.
+  void Flush();
+
+  uint64_t lines() const { return lines_; }
+
+ private:
+  void ParseLine(const char* line, size_t len, double now);
+  void CloseFrame();
+  void CloseBucket();
+  void AppendRow(double t, const float* values);
+  void NewBatch();
+
+  size_t prefix_;
+  int capacity_;
+  double bucket_seconds_;
+  BatchCallback on_batch_;
+
+  char line_[128];
+  size_t line_len_ = 0;
+  uint64_t lines_ = 0;
+
+  // Frame being assembled; channels keep their last value. The
+  // extremes default to it when no _min/_max line came with it.
+  float frame_[kTelemetryChannels] = {};
+  float frame_min_[kTelemetryChannels] = {};
+  float frame_max_[kTelemetryChannels] = {};
+  unsigned frame_mask_ = 0;
+  unsigned extreme_mask_ = 0;  // channels with a _min or _max this frame
+  double frame_time_ = 0;
+  double time_origin_ = -1;
+
+  // Current min/max bucket
+  bool bucket_open_ = false;
+  double bucket_start_ = 0;
+  int bucket_frames_ = 0;
+  float min_[kTelemetryChannels];
+  float max_[kTelemetryChannels];
+  double min_time_[kTelemetryChannels];
+  double max_time_[kTelemetryChannels];
+
+  uint8_t* batch_ = nullptr;
+  float* words_ = nullptr;
+  double time_base_ = 0;
+  int rows_ = 0;
+  int frames_ = 0;
+  uint32_t dropped_ = 0;
+};
+
+// Reads telemetry from a serial device or pty path, or from
+// "tcp://host:port", on a background thread. Reconnects until stopped
+// and delivers decimated batches about once per display frame.
+class TelemetryIngest {
+ public:
+  TelemetryIngest() = default;
+  ~TelemetryIngest();
+
+  TelemetryIngest(const TelemetryIngest&) = delete;
+  TelemetryIngest& operator=(const TelemetryIngest&) = delete;
+
+  // Every batch is appended to `store` (if set) on the ingest thread,
+  // before delivery, so history is kept even while the UI lags.
+  void set_store(TelemetryStore* store) { store_ = store; }
+
+  bool Start(const std::string& uri, size_t prefix,
+             TelemetryParser::BatchCallback on_batch);
+  void Stop();
+
+  // Called by the consumer once a delivered batch has been handed off;
+  // while too many are in flight, new batches are dropped and counted.
+  void BatchConsumed() { in_flight_--; }
+
+ private:
+  void Run();
+  int Open();
+
+  std::string uri_;
+  size_t prefix_ = 0;
+  TelemetryParser::BatchCallback on_batch_;
+  TelemetryStore* store_ = nullptr;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int> in_flight_{0};
+  int wake_[2] = {-1, -1};
+};
+
+#endif  // RUNNER_TELEMETRY_INGEST_H_
@@ -0,0 +1,509 @@
+#include "telemetry_store.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct TierSpec {
+  const char* name;
+  double resolution;   // seconds per row (nominal for raw)
+  int stats;           // float columns per channel
+  uint32_t capacity;   // rows per segment
+  double retention;    // seconds; 0 keeps everything
+  uint64_t budget;     // bytes on disk
+};
+
+// Raw rows arrive at up to 500/s; a raw segment holds ~35 min of a
+// full-rate stream and the 1 s tier one day per segment.
+constexpr double kDay = 86400;
+const TierSpec kTiers[kTierCount] = {
+    {"raw", 0.004, 1, 1u << 20, 2 * kDay, 512ull << 20},
+    {"1s", 1, 3, 86400, 30 * kDay, 256ull << 20},
+    {"1min", 60, 3, 1u << 16, 400 * kDay, 64ull << 20},
+    {"1h", 3600, 3, 1u << 16, 0, 64ull << 20},
+};
+
+enum { kStatMin = 0, kStatMax, kStatMean };
+
+constexpr char kSegmentMagic[4] = {'G', 'M', 'T', 'S'};
+// Version 2 added the rollup count column. Version 1 segments are
+// still read (each row weighs 1) but never appended to. So are
+// segments from a build with fewer channels: columns are laid out
+// channel by channel, so the ones they have sit where they always did.
+constexpr uint32_t kSegmentVersion = 2;
+
+struct SegmentHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t tier;
+  uint32_t channels;
+  uint32_t stats;
+  uint32_t capacity;
+  uint64_t rows;  // updated after the row's columns are written
+  double first_time;
+  uint8_t reserved[24];
+};
+static_assert(sizeof(SegmentHeader) == 64, "segment header must stay 64 bytes");
+
+bool HasCounts(int tier, uint32_t version) {
+  return tier != kTierRaw && version >= 2;
+}
+
+size_t SegmentBytes(int tier, uint32_t version = kSegmentVersion,
+                    uint32_t channels = kTelemetryChannels) {
+  const TierSpec& spec = kTiers[tier];
+  return sizeof(SegmentHeader) +
+         static_cast<size_t>(spec.capacity) *
+             (sizeof(double) + (HasCounts(tier, version) ? sizeof(uint32_t) : 0) +
+              sizeof(float) * channels * spec.stats);
+}
+
+
+SegmentHeader* Header(uint8_t* map) {
+  return reinterpret_cast<SegmentHeader*>(map);
+}
+
+// Whether new rows can be stored into the segment as it is
+bool Current(uint8_t* map) {
+  return Header(map)->version == kSegmentVersion &&
+         Header(map)->channels == kTelemetryChannels;
+}
+
+double* TimeColumn(uint8_t* map) {
+  return reinterpret_cast<double*>(map + sizeof(SegmentHeader));
+}
+
+// Samples folded into each row; nullptr where every row weighs 1
+// (raw tier, version 1 segments)
+uint32_t* CountColumn(uint8_t* map, int tier) {
+  if (!HasCounts(tier, Header(map)->version)) return nullptr;
+  return reinterpret_cast<uint32_t*>(map + sizeof(SegmentHeader) +
+                                     sizeof(double) * kTiers[tier].capacity);
+}
+
+float* Column(uint8_t* map, int tier, int channel, int stat) {
+  const TierSpec& spec = kTiers[tier];
+  size_t index = static_cast<size_t>(channel) * spec.stats + stat;
+  size_t counts = HasCounts(tier, Header(map)->version) ? sizeof(uint32_t) * spec.capacity : 0;
+  return reinterpret_cast<float*>(map + sizeof(SegmentHeader) +
+                                  sizeof(double) * spec.capacity + counts +
+                                  sizeof(float) * spec.capacity * index);
+}
+
+bool MakeDir(const std::string& path) {
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+}  // namespace
+
+TelemetryStore::~TelemetryStore() { Close(); }
+
+bool TelemetryStore::Open(const std::string& dir) {
+  Close();
+  std::lock_guard<std::mutex> lock(mutex_);
+  root_ = dir;
+  if (!MakeDir(root_)) return false;
+
+  for (int k = 0; k < kTierCount; k++) {
+    Tier& tier = tiers_[k];
+    tier.dir = root_ + "/" + kTiers[k].name;
+    if (!MakeDir(tier.dir)) return false;
+
+    std::vector<std::string> names;
+    if (DIR* d = opendir(tier.dir.c_str())) {
+      while (dirent* e = readdir(d)) {
+        size_t len = strlen(e->d_name);
+        if (len > 4 && strcmp(e->d_name + len - 4, ".seg") == 0) {
+          names.push_back(e->d_name);
+        }
+      }
+      closedir(d);
+    }
+    // Names are zero-padded start times, so lexical order is time order
+    std::sort(names.begin(), names.end());
+    for (const std::string& name : names) {
+      Segment seg;
+      seg.path = tier.dir + "/" + name;
+      if (!MapSegment(k, &seg, false)) {
+        fprintf(stderr, "telemetry store: skipping unreadable %s\n",
+                seg.path.c_str());
+        continue;
+      }
+      tier.segments.push_back(seg);
+    }
+    if (!tier.segments.empty()) {
+      // Appending resumes here; an older build may have left it sparse
+      Segment& last = tier.segments.back();
+      last.reserved = Current(last.map) &&
+                      posix_fallocate(last.fd, 0, last.map_size) == 0;
+      uint8_t* map = last.map;
+      uint64_t rows = Header(map)->rows;
+      tier.last_time = rows ? TimeColumn(map)[rows - 1] : -1;
+      if (k != kTierRaw) ReopenBucket(k);
+    }
+  }
+  open_ = true;
+  return true;
+}
+
+void TelemetryStore::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Store the partial rollup buckets so a clean exit loses nothing.
+  // Finest first: each one folds into the next tier's open bucket
+  // before that is stored.
+  for (int k = kTierSecond; k < kTierCount && open_; k++) {
+    if (tiers_[k].acc.bucket < 0) continue;
+    StoreBucket(k);
+    tiers_[k].acc.bucket = -1;
+  }
+  for (Tier& tier : tiers_) {
+    for (Segment& seg : tier.segments) UnmapSegment(&seg);
+    tier.segments.clear();
+    tier.last_time = -1;
+    tier.acc.bucket = -1;
+    tier.open_row = false;
+  }
+  last_stream_ = -1;
+  open_ = false;
+}
+
+bool TelemetryStore::MapSegment(int tier, Segment* seg, bool create) {
+  size_t size = SegmentBytes(tier);
+  int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0);
+  int fd = open(seg->path.c_str(), flags, 0644);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (!create) {
+    // The header says which layout; it is checked against the size below
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+      close(fd);
+      return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+  }
+  // A new segment gets all its blocks now: stores into the mapping
+  // must never need the disk to find space
+  if (create) {
+    int err = posix_fallocate(fd, 0, size);
+    if (err != 0) {
+      close(fd);
+      unlink(seg->path.c_str());
+      errno = err;
+      return false;
+    }
+  }
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  seg->map = static_cast<uint8_t*>(map);
+  seg->map_size = size;
+  seg->fd = fd;
+  seg->reserved = create;
+
+  SegmentHeader* h = Header(seg->map);
+  if (create) {
+    memcpy(h->magic, kSegmentMagic, sizeof(kSegmentMagic));
+    h->version = kSegmentVersion;
+    h->tier = tier;
+    h->channels = kTelemetryChannels;
+    h->stats = kTiers[tier].stats;
+    h->capacity = kTiers[tier].capacity;
+    h->rows = 0;
+    h->first_time = seg->first_time;
+  } else if (memcmp(h->magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0 ||
+             h->version < 1 || h->version > kSegmentVersion || h->channels < 1 ||
+             h->channels > kTelemetryChannels ||
+             size != SegmentBytes(tier, h->version, h->channels) ||
+             h->tier != static_cast<uint32_t>(tier) ||
+             h->capacity != kTiers[tier].capacity || h->rows > h->capacity) {
+    UnmapSegment(seg);
+    return false;
+  }
+  seg->first_time = h->first_time;
+  return true;
+}
+
+void TelemetryStore::UnmapSegment(Segment* seg) {
+  if (seg->map) {
+    msync(seg->map, seg->map_size, MS_ASYNC);
+    munmap(seg->map, seg->map_size);
+  }
+  if (seg->fd >= 0) close(seg->fd);
+  seg->map = nullptr;
+  seg->fd = -1;
+}
+
+TelemetryStore::Segment* TelemetryStore::Writable(int tier, double t) {
+  Tier& tr = tiers_[tier];
+  if (!tr.segments.empty() && tr.segments.back().reserved &&
+      Header(tr.segments.back().map)->rows < kTiers[tier].capacity) {
+    return &tr.segments.back();
+  }
+
+  Segment seg;
+  seg.first_time = t;
+  char name[32];
+  snprintf(name, sizeof(name), "%015lld.seg", static_cast<long long>(std::llround(t * 1000)));
+  seg.path = tr.dir + "/" + name;
+  if (!MapSegment(tier, &seg, true)) {
+    if (!tr.failing) {
+      fprintf(stderr, "telemetry store: cannot create %s: %s\n", seg.path.c_str(),
+              strerror(errno));
+    }
+    tr.failing = true;
+    return nullptr;
+  }
+  tr.failing = false;
+  if (!tr.segments.empty()) msync(tr.segments.back().map, tr.segments.back().map_size, MS_ASYNC);
+  tr.segments.push_back(seg);
+  EnforceRetention(tier, t);
+  return &tr.segments.back();
+}
+
+// Drops whole segments from the old end while they are past retention
+// or the tier is over its byte budget. The newest segment always stays.
+void TelemetryStore::EnforceRetention(int tier, double now) {
+  const TierSpec& spec = kTiers[tier];
+  std::vector<Segment>& segs = tiers_[tier].segments;
+  while (segs.size() > 1) {
+    bool expired = spec.retention > 0 && segs[1].first_time < now - spec.retention;
+    if (!expired && TierBytes(tier) <= spec.budget) break;
+    UnmapSegment(&segs.front());
+    unlink(segs.front().path.c_str());
+    segs.erase(segs.begin());
+  }
+}
+
+uint64_t TelemetryStore::TierBytes(int tier) {
+  uint64_t bytes = 0;
+  struct stat st;
+  for (const Segment& seg : tiers_[tier].segments) {
+    if (fstat(seg.fd, &st) == 0) bytes += static_cast<uint64_t>(st.st_blocks) * 512;
+  }
+  return bytes;
+}
+
+uint64_t TelemetryStore::DiskBytes(int tier) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tier >= 0 && tier < kTierCount ? TierBytes(tier) : 0;
+}
+
+void TelemetryStore::AppendRow(int tier, double t, const float* min,
+                               const float* max, const float* mean, uint64_t count) {
+  Tier& tr = tiers_[tier];
+  Segment* seg;
+  uint64_t row;
+  if (t == tr.last_time && tr.open_row) {
+    // The reopened bucket, stored again with what came since
+    seg = &tr.segments.back();
+    row = Header(seg->map)->rows - 1;
+  } else {
+    if (t <= tr.last_time) return;  // time must increase within a tier
+    seg = Writable(tier, t);
+    if (!seg) return;
+    row = Header(seg->map)->rows;
+  }
+
+  SegmentHeader* h = Header(seg->map);
+  TimeColumn(seg->map)[row] = t;
+  if (uint32_t* counts = CountColumn(seg->map, tier)) {
+    counts[row] = static_cast<uint32_t>(std::min<uint64_t>(count, UINT32_MAX));
+  }
+  for (int c = 0; c < kTelemetryChannels; c++) {
+    if (tier == kTierRaw) {
+      Column(seg->map, tier, c, 0)[row] = mean[c];
+    } else {
+      Column(seg->map, tier, c, kStatMin)[row] = min[c];
+      Column(seg->map, tier, c, kStatMax)[row] = max[c];
+      Column(seg->map, tier, c, kStatMean)[row] = mean[c];
+    }
+  }
+  if (row == h->rows) h->rows = row + 1;
+  tr.last_time = t;
+  tr.open_row = false;
+}
+
+// Stores `tier`'s open bucket as a row and folds into the next tier
+// what that has not seen yet.
+void TelemetryStore::StoreBucket(int tier) {
+  Accumulator& acc = tiers_[tier].acc;
+  float mean[kTelemetryChannels];
+  for (int c = 0; c < kTelemetryChannels; c++) {
+    mean[c] = static_cast<float>(acc.sum[c] / acc.count);
+  }
+  AppendRow(tier, acc.bucket, acc.min, acc.max, mean, acc.count);
+
+  uint64_t fresh = acc.count - acc.folded_count;
+  if (tier + 1 < kTierCount && fresh > 0) {
+    float m[kTelemetryChannels];
+    for (int c = 0; c < kTelemetryChannels; c++) {
+      m[c] = static_cast<float>((acc.sum[c] - acc.folded_sum[c]) / fresh);
+    }
+    Fold(tier + 1, acc.bucket, acc.min, acc.max, m, fresh);
+  }
+  acc.folded_count = acc.count;
+  for (int c = 0; c < kTelemetryChannels; c++) acc.folded_sum[c] = acc.sum[c];
+}
+
+// Takes the last row of a rollup tier back as its open bucket. The
+// row was stored by Close() and already folded into the next tier.
+// Rows of an older layout cannot be rewritten and are left closed.
+void TelemetryStore::ReopenBucket(int tier) {
+  Tier& tr = tiers_[tier];
+  uint8_t* map = tr.segments.back().map;
+  uint64_t rows = Header(map)->rows;
+  const uint32_t* counts = CountColumn(map, tier);
+  if (rows == 0 || !Current(map) || counts[rows - 1] == 0) return;
+
+  uint64_t r = rows - 1;
+  Accumulator& acc = tr.acc;
+  acc.bucket = TimeColumn(map)[r];
+  acc.count = counts[r];
+  for (int c = 0; c < kTelemetryChannels; c++) {
+    acc.min[c] = Column(map, tier, c, kStatMin)[r];
+    acc.max[c] = Column(map, tier, c, kStatMax)[r];
+    acc.sum[c] = static_cast<double>(Column(map, tier, c, kStatMean)[r]) * acc.count;
+    acc.folded_sum[c] = acc.sum[c];
+  }
+  acc.folded_count = acc.count;
+  tr.open_row = true;
+}
+
+// Adds a row to `tier`'s open bucket; when a row lands in a later
+// bucket the finished one is stored and folded into the next tier.
+void TelemetryStore::Fold(int tier, double t, const float* min, const float* max,
+                          const float* mean, uint64_t count) {
+  Accumulator& acc = tiers_[tier].acc;
+  double res = kTiers[tier].resolution;
+  double bucket = std::floor(t / res) * res;
+
+  if (acc.bucket >= 0 && bucket != acc.bucket) {
+    StoreBucket(tier);
+    acc.bucket = -1;
+  }
+  if (acc.bucket < 0) {
+    acc.bucket = bucket;
+    acc.count = 0;
+    acc.folded_count = 0;
+    for (int c = 0; c < kTelemetryChannels; c++) {
+      acc.min[c] = min[c];
+      acc.max[c] = max[c];
+      acc.sum[c] = 0;
+      acc.folded_sum[c] = 0;
+    }
+  }
+  for (int c = 0; c < kTelemetryChannels; c++) {
+    acc.min[c] = std::min(acc.min[c], min[c]);
+    acc.max[c] = std::max(acc.max[c], max[c]);
+    acc.sum[c] += static_cast<double>(mean[c]) * count;
+  }
+  acc.count += count;
+}
+
+void TelemetryStore::AppendBatch(const float* words, double wall_now) {
+  int capacity = static_cast<int>(words[2]);
+  int rows = static_cast<int>(words[3]);
+  if (static_cast<int>(words[0]) != kBatchFormatVersion || rows <= 0) return;
+  double base;
+  memcpy(&base, &words[6], sizeof(base));
+  const float* columns = words + kBatchHeaderWords;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!open_) return;
+  double stream_last = base + columns[rows - 1];
+  if (last_stream_ < 0 || base < last_stream_) anchor_ = wall_now - stream_last;
+  last_stream_ = stream_last;
+
+  float v[kTelemetryChannels];
+  for (int r = 0; r < rows; r++) {
+    double t = anchor_ + base + columns[r];
+    for (int c = 0; c < kTelemetryChannels; c++) v[c] = columns[(c + 1) * capacity + r];
+    AppendRow(kTierRaw, t, v, v, v, 1);
+    Fold(kTierSecond, t, v, v, v, 1);
+  }
+}
+
+bool TelemetryStore::Query(int channel, double from, double to, int max_points,
+                           TelemetrySeries* out) {
+  if (channel < 0 || channel >= kTelemetryChannels || !(to > from) || max_points <= 0) {
+    return false;
+  }
+  max_points = std::min(max_points, kMaxQueryPoints);
+  double width = (to - from) / max_points;
+  int tier = kTierRaw;
+  for (int k = kTierCount - 1; k > kTierRaw; k--) {
+    if (kTiers[k].resolution <= width) {
+      tier = k;
+      break;
+    }
+  }
+
+  std::vector<float> mins(max_points), maxs(max_points);
+  std::vector<double> sums(max_points), weights(max_points);
+  std::vector<uint32_t> counts(max_points);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!open_) return false;
+  const std::vector<Segment>& segs = tiers_[tier].segments;
+  bool raw = tier == kTierRaw;
+  for (size_t i = 0; i < segs.size(); i++) {
+    if (segs[i].first_time >= to) break;
+    if (i + 1 < segs.size() && segs[i + 1].first_time <= from) continue;
+
+    uint8_t* map = segs[i].map;
+    // Written before the channel existed
+    if (static_cast<uint32_t>(channel) >= Header(map)->channels) continue;
+    uint64_t rows = Header(map)->rows;
+    const double* time = TimeColumn(map);
+    const float* cmin = Column(map, tier, channel, raw ? 0 : kStatMin);
+    const float* cmax = Column(map, tier, channel, raw ? 0 : kStatMax);
+    const float* cmean = Column(map, tier, channel, raw ? 0 : kStatMean);
+    const uint32_t* weight = CountColumn(map, tier);
+
+    for (uint64_t r = std::lower_bound(time, time + rows, from) - time;
+         r < rows && time[r] < to; r++) {
+      int b = std::min(static_cast<int>((time[r] - from) / width), max_points - 1);
+      if (counts[b] == 0) {
+        mins[b] = cmin[r];
+        maxs[b] = cmax[r];
+      } else {
+        mins[b] = std::min(mins[b], cmin[r]);
+        maxs[b] = std::max(maxs[b], cmax[r]);
+      }
+      // A rollup mean stands for all the samples folded into it
+      double w = weight ? weight[r] : 1;
+      sums[b] += cmean[r] * w;
+      weights[b] += w;
+      counts[b]++;
+    }
+  }
+
+  out->tier = tier;
+  out->time.clear();
+  out->min.clear();
+  out->max.clear();
+  out->mean.clear();
+  out->count.clear();
+  for (int b = 0; b < max_points; b++) {
+    if (counts[b] == 0) continue;
+    out->time.push_back(from + b * width);
+    out->min.push_back(mins[b]);
+    out->max.push_back(maxs[b]);
+    out->mean.push_back(static_cast<float>(weights[b] > 0 ? sums[b] / weights[b] : 0));
+    out->count.push_back(static_cast<uint64_t>(weights[b]));
+  }
+  return true;
+}
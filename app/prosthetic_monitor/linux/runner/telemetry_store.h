@@ -0,0 +1,145 @@
+#ifndef RUNNER_TELEMETRY_STORE_H_
+#define RUNNER_TELEMETRY_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "telemetry_ingest.h"
+
+// Rollup tiers. Tier 0 keeps the decimated ingest rows; each coarser
+// tier is folded from the one below it at ingest time, so a query of
+// any span reads a few thousand rows from the tier that fits it.
+enum TelemetryTier {
+  kTierRaw = 0,
+  kTierSecond,
+  kTierMinute,
+  kTierHour,
+  kTierCount
+};
+
+// Most buckets one Query returns; more than a screen's width of
+// points buys nothing and each bucket costs memory up front.
+constexpr int kMaxQueryPoints = 8192;
+
+// One downsampled series returned by TelemetryStore::Query. Times are
+// Unix seconds at the start of each output bucket.
+struct TelemetrySeries {
+  int tier = kTierRaw;
+  std::vector<double> time;
+  std::vector<float> min;
+  std::vector<float> max;
+  std::vector<float> mean;
+  std::vector<uint64_t> count;  // samples behind each bucket
+};
+
+// Embedded columnar time-series store for telemetry history.
+//
+// Each tier is a directory of fixed-capacity segment files named by
+// their first timestamp. A segment is a 64-byte header followed by a
+// float64 time column, for rollups a uint32 column of the samples
+// folded into each row, and one float32 column per channel and
+// statistic (value only for the raw tier; min, max and mean for
+// rollups), each `capacity` rows long. Query weights each rollup mean
+// by that count, so a row built from a few samples around a stream
+// gap does not weigh as much as a full one.
+//
+// Files are memory-mapped, so appending is a store into the mapping
+// and reads never copy. A segment's blocks are reserved with
+// posix_fallocate() before anything is stored into it: a store into a
+// hole on a full disk would raise SIGBUS, so a full disk fails the
+// segment's creation instead and rows are dropped until space frees.
+//
+// Close() stores each tier's open rollup bucket as a row, folded on
+// into the coarser tiers like a finished one. Open() takes the last
+// row of each rollup tier back as its open bucket, so a restart inside
+// the same second, minute or hour keeps adding to that row instead of
+// being dropped as out of order.
+//
+// Retention is enforced per tier when a segment rolls over: whole
+// segments older than the tier's retention, or beyond its byte budget,
+// are deleted. Disk use is therefore bounded regardless of uptime.
+//
+// Append runs on the ingest thread and Query on the platform thread;
+// a single mutex serialises them.
+class TelemetryStore {
+ public:
+  TelemetryStore() = default;
+  ~TelemetryStore();
+
+  TelemetryStore(const TelemetryStore&) = delete;
+  TelemetryStore& operator=(const TelemetryStore&) = delete;
+
+  // Opens (creating if needed) the store rooted at `dir` and reopens the
+  // newest segment of each tier for appending.
+  bool Open(const std::string& dir);
+  void Close();
+
+  // Appends the rows of an ingest batch (see telemetry_ingest.h).
+  // `wall_now` anchors the stream clock to Unix time; the anchor is
+  // kept until the stream clock jumps backwards (device reset).
+  void AppendBatch(const float* words, double wall_now);
+
+  // Downsamples channel `channel` over [from, to) into at most
+  // `max_points` buckets (clamped to kMaxQueryPoints), reading the
+  // coarsest tier that still gives each bucket at least one row.
+  bool Query(int channel, double from, double to, int max_points,
+             TelemetrySeries* out);
+
+  // Total bytes of segment files on disk, per tier.
+  uint64_t DiskBytes(int tier);
+
+ private:
+  struct Segment {
+    std::string path;
+    double first_time = 0;
+    uint8_t* map = nullptr;
+    size_t map_size = 0;
+    int fd = -1;
+    bool reserved = false;  // blocks allocated; safe to append to
+  };
+
+  struct Accumulator {
+    double bucket = -1;
+    float min[kTelemetryChannels];
+    float max[kTelemetryChannels];
+    double sum[kTelemetryChannels];
+    uint64_t count = 0;
+    // Share of sum/count already folded into the next tier (a bucket
+    // stored by Close() and reopened)
+    double folded_sum[kTelemetryChannels];
+    uint64_t folded_count = 0;
+  };
+
+  struct Tier {
+    std::string dir;
+    std::vector<Segment> segments;  // oldest first; last is being appended
+    double last_time = -1;
+    Accumulator acc;  // rollup bucket being filled (unused for raw)
+    bool open_row = false;  // last stored row is acc, rewritten in place
+    bool failing = false;  // last segment creation failed; logged once
+  };
+
+  void AppendRow(int tier, double t, const float* min, const float* max,
+                 const float* mean, uint64_t count);
+  void Fold(int tier, double t, const float* min, const float* max,
+            const float* mean, uint64_t count);
+  void StoreBucket(int tier);
+  void ReopenBucket(int tier);
+  bool MapSegment(int tier, Segment* seg, bool create);
+  void UnmapSegment(Segment* seg);
+  Segment* Writable(int tier, double t);
+  void EnforceRetention(int tier, double now);
+  uint64_t TierBytes(int tier);
+
+  std::mutex mutex_;
+  std::string root_;
+  Tier tiers_[kTierCount];
+  double anchor_ = 0;      // Unix time minus stream time
+  double last_stream_ = -1;
+  bool open_ = false;
+};
+
+#endif  // RUNNER_TELEMETRY_STORE_H_
@@ -0,0 +1,92 @@
+#include "telemetry_ingest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                  \
+  do {                                                               \
+    if (!(cond)) {                                                   \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                \
+      failures++;                                                    \
+    }                                                                \
+  } while (0)
+
+constexpr int kCapacity = 16;
+
+// Parses `text` fed at host time `now`, one call per entry, and returns
+// the rows of each column of the batch Flush() emits.
+std::vector<std::vector<float>> Parse(const std::vector<std::pair<double, const char*>>& feeds) {
+  std::vector<std::vector<float>> columns;
+  TelemetryParser parser(0, kCapacity, 0.004, [&](uint8_t* payload, size_t) {
+    const float* words = reinterpret_cast<const float*>(payload);
+    int rows = static_cast<int>(words[3]);
+    columns.assign(kBatchColumns, {});
+    for (int c = 0; c < kBatchColumns; c++) {
+      const float* column = words + kBatchHeaderWords + c * kCapacity;
+      columns[c].assign(column, column + rows);
+    }
+    free(payload);
+    return true;
+  });
+  for (const auto& feed : feeds) parser.Feed(feed.second, strlen(feed.second), feed.first);
+  parser.Flush();
+  return columns;
+}
+
+int Column(const char* name) {
+  for (int i = 0; i < kTelemetryChannels; i++) {
+    if (strcmp(kTelemetryChannelNames[i], name) == 0) return i + 1;
+  }
+  return -1;
+}
+
+// A decimated channel's _min/_max reach the bucket's extremes; the
+// current channel is kept; lines for other fields are ignored.
+void TestExtremesAndCurrent() {
+  const char* frame =
+      ">rms:1.0\n>rms_min:0.5\n>rms_max:2.0\n>threshold:0.1\n>muscle:0\n"
+      ">angle:10\n>state:0\n>current:0.3\n>overruns:7\n";
+  auto columns = Parse({{0.0, frame}, {1.0, ">rms:1.0\n"}});
+  CHECK(columns.size() == static_cast<size_t>(kBatchColumns));
+  if (columns.size() != static_cast<size_t>(kBatchColumns)) return;
+
+  // One frame with a spread: a min row, then a max row
+  const std::vector<float>& rms = columns[Column("rms")];
+  CHECK(rms.size() == 2);
+  if (rms.size() == 2) CHECK(rms[0] == 0.5f && rms[1] == 2.0f);
+  const std::vector<float>& current = columns[Column("current")];
+  CHECK(current.size() == 2);
+  for (float v : current) CHECK(v == 0.3f);
+  for (float v : columns[Column("threshold")]) CHECK(v == 0.1f);
+}
+
+// Extremes only count with their channel's value in the same frame;
+// a frame without them is one row at the value.
+void TestExtremeWithoutValue() {
+  auto columns = Parse({{0.0, ">current_max:9\n>rms:1.0\n>rms_max:3.0\n"},
+                        {1.0, ">rms:2.0\n>current_min:-1\n"},
+                        {2.0, ">rms:1.0\n"}});
+  CHECK(columns.size() == static_cast<size_t>(kBatchColumns));
+  if (columns.size() != static_cast<size_t>(kBatchColumns)) return;
+  const std::vector<float>& rms = columns[Column("rms")];
+  const std::vector<float>& current = columns[Column("current")];
+  CHECK(rms.size() == 3);
+  if (rms.size() == 3) CHECK(rms[0] == 1.0f && rms[1] == 3.0f && rms[2] == 2.0f);
+  for (float v : current) CHECK(v == 0.0f);
+}
+
+}  // namespace
+
+int main() {
+  TestExtremesAndCurrent();
+  TestExtremeWithoutValue();
+  if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+#include "telemetry_store.h"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                  \
+  do {                                                               \
+    if (!(cond)) {                                                   \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                \
+      failures++;                                                    \
+    }                                                                \
+  } while (0)
+
+constexpr double kHour = 3600.0 * 1000;  // an hour boundary, Unix seconds
+
+// One ingest batch of `rows` rows, one per second from Unix time
+// `first`, every channel at `value`.
+void Append(TelemetryStore* store, double first, int rows, float value) {
+  std::vector<float> words(kBatchHeaderWords + kBatchColumns * rows);
+  words[0] = kBatchFormatVersion;
+  words[1] = kBatchColumns;
+  words[2] = static_cast<float>(rows);
+  words[3] = static_cast<float>(rows);
+  double base = 0;
+  memcpy(&words[6], &base, sizeof(base));
+  float* columns = words.data() + kBatchHeaderWords;
+  for (int r = 0; r < rows; r++) {
+    columns[r] = static_cast<float>(r);
+    for (int c = 0; c < kTelemetryChannels; c++) columns[(c + 1) * rows + r] = value;
+  }
+  // The store anchors the stream's last row to the wall clock
+  store->AppendBatch(words.data(), first + rows - 1);
+}
+
+bool Bucket(TelemetryStore* store, double from, double to, TelemetrySeries* s) {
+  return store->Query(0, from, to, 1, s) && s->time.size() == 1;
+}
+
+std::string TempDir() {
+  char dir[] = "/tmp/telemetry_store_test_XXXXXX";
+  return mkdtemp(dir) ? dir : "";
+}
+
+// Two app runs inside one hour, the second starting inside the
+// minute the first ended in: the minute and hour rows must hold both.
+void TestRestartInsideBucket() {
+  std::string dir = TempDir();
+  CHECK(!dir.empty());
+  {
+    TelemetryStore store;
+    CHECK(store.Open(dir));
+    Append(&store, kHour + 10, 600, 1.0f);   // :00:10 .. :10:09
+    store.Close();
+    CHECK(store.Open(dir));
+    Append(&store, kHour + 630, 600, 3.0f);  // :10:30 .. :20:29
+    store.Close();
+  }
+
+  TelemetryStore store;
+  CHECK(store.Open(dir));
+  TelemetrySeries s;
+  CHECK(Bucket(&store, kHour, kHour + 3600, &s));
+  CHECK(s.tier == kTierHour);
+  if (s.tier == kTierHour && s.count.size() == 1) {
+    CHECK(s.count[0] == 1200);
+    CHECK(std::fabs(s.mean[0] - 2.0f) < 1e-4f);
+    CHECK(s.min[0] == 1.0f);
+    CHECK(s.max[0] == 3.0f);
+  }
+  // Minute :10 has 10 rows of the first run and 30 of the second
+  CHECK(Bucket(&store, kHour + 600, kHour + 660, &s));
+  CHECK(s.tier == kTierMinute);
+  if (s.tier == kTierMinute && s.count.size() == 1) {
+    CHECK(s.count[0] == 40);
+    CHECK(std::fabs(s.mean[0] - 2.5f) < 1e-4f);
+  }
+
+  // A third run in a later hour closes the reopened buckets unchanged
+  Append(&store, kHour + 3600 + 5, 10, 5.0f);
+  store.Close();
+  CHECK(store.Open(dir));
+  CHECK(Bucket(&store, kHour, kHour + 3600, &s));
+  if (s.count.size() == 1) CHECK(s.count[0] == 1200);
+  CHECK(Bucket(&store, kHour + 3600, kHour + 7200, &s));
+  if (s.count.size() == 1) CHECK(s.count[0] == 10);
+  store.Close();
+  std::string rm = "rm -rf " + dir;
+  CHECK(system(rm.c_str()) == 0);
+}
+
+// A 1 s segment as a five-channel build left it, one row at `t`:
+// every channel's min/max/mean at `value`, `count` samples.
+void WriteFiveChannelSegment(const std::string& dir, double t, float value,
+                             uint32_t count) {
+  constexpr uint32_t kChannels = 5, kStats = 3, kCapacity = 86400;
+  CHECK(mkdir(dir.c_str(), 0755) == 0);
+  std::string path = dir + "/000000000000000.seg";
+  struct {
+    char magic[4] = {'G', 'M', 'T', 'S'};
+    uint32_t version = 2, tier = kTierSecond, channels = kChannels;
+    uint32_t stats = kStats, capacity = kCapacity;
+    uint64_t rows = 1;
+    double first_time;
+    uint8_t reserved[24] = {};
+  } header;
+  static_assert(sizeof(header) == 64, "segment header is 64 bytes");
+  header.first_time = t;
+  std::vector<double> time(kCapacity);
+  std::vector<uint32_t> counts(kCapacity);
+  std::vector<float> column(kCapacity);
+  time[0] = t;
+  counts[0] = count;
+  column[0] = value;
+
+  FILE* f = fopen(path.c_str(), "wb");
+  CHECK(f != nullptr);
+  if (!f) return;
+  fwrite(&header, sizeof(header), 1, f);
+  fwrite(time.data(), sizeof(double), kCapacity, f);
+  fwrite(counts.data(), sizeof(uint32_t), kCapacity, f);
+  for (uint32_t i = 0; i < kChannels * kStats; i++) {
+    fwrite(column.data(), sizeof(float), kCapacity, f);
+  }
+  fclose(f);
+}
+
+// History from before a channel was added stays readable; the new
+// channel starts with the first rows stored after the upgrade.
+void TestOlderChannelCount() {
+  std::string dir = TempDir();
+  CHECK(!dir.empty());
+  WriteFiveChannelSegment(dir + "/1s", kHour, 4.0f, 250);
+
+  TelemetryStore store;
+  CHECK(store.Open(dir));
+  TelemetrySeries s;
+  CHECK(Bucket(&store, kHour, kHour + 1, &s));
+  CHECK(s.tier == kTierSecond);
+  if (s.count.size() == 1) {
+    CHECK(s.count[0] == 250);
+    CHECK(s.mean[0] == 4.0f);
+  }
+  int current = kTelemetryChannels - 1;
+  CHECK(store.Query(current, kHour, kHour + 1, 1, &s));
+  CHECK(s.time.empty());
+
+  // Stored into a new segment with every channel
+  Append(&store, kHour + 10, 20, 2.0f);
+  store.Close();
+  CHECK(store.Open(dir));
+  CHECK(store.Query(current, kHour, kHour + 30, 30, &s));
+  CHECK(s.tier == kTierSecond);
+  CHECK(s.time.size() == 20);
+  if (!s.time.empty()) CHECK(s.time[0] == kHour + 10 && s.mean[0] == 2.0f);
+  store.Close();
+  std::string rm = "rm -rf " + dir;
+  CHECK(system(rm.c_str()) == 0);
+}
+
+}  // namespace
+
+int main() {
+  TestRestartInsideBucket();
+  TestOlderChannelCount();
+  if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,416 @@
+// ===================================================
+//  sEMG GRIP — PARALLEL CORPUS ANALYTICS
+//
+//  Replays every session of a corpus through the
+//  firmware DSP and hand state machine (one virtual-
+//  time firmware instance per worker thread) and
+//  prints one summary table. Samples are streamed in
+//  fixed blocks and never held whole. What a worker
+//  keeps per session grows with its length: the
+//  labels (room for one per second), a hit flag each
+//  and the gesture times. Only the corpus size does
+//  not change memory.
+//
+//  Gestures are scored against the labels: two
+//  contractions less than GESTURE_TRUTH_GAP_MS apart
+//  are a deliberate double flex (emgsynth --doubles),
+//  which should fire one gesture. Latency is measured
+//  from the end of the second flex; any other gesture
+//  is a false detection.
+//
+//  usage: batch <dir|file.ses>... [options]
+//    --threads T    worker threads (default: all cores)
+//    --loop-us N    modelled loop cost per pass, for
+//                   overrun estimation (default 20)
+//    --csv FILE     also write one row per session
+// ===================================================
+#include <ConfigStore.h>
+#include <Gesture.h>
+#include <GripControl.h>
+#include <SessionFile.h>
+#include <SimHal.h>
+#include <WorkPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <vector>
+
+#define BLOCK_SAMPLES  4096
+#define HOLD_BIN_MS    100
+#define HOLD_BINS      600     // 0 .. 60 s, last bin is overflow
+#define GESTURE_TRUTH_GAP_MS  900     // emgsynth rests are >= 1 s
+#define GESTURE_MATCH_MS      3000    // detection window after the second flex
+
+// ===================================================
+//  METRICS
+// ===================================================
+struct Totals {
+  uint64_t sessions = 0, failed = 0, samples = 0;
+  uint64_t grips = 0, holds = 0, falseAct = 0, missed = 0;
+  uint64_t labelled = 0, labels = 0, overruns = 0;
+  uint64_t gestures = 0, doubles = 0, gestureHits = 0, falseGestures = 0;
+  uint64_t gestureLatSumMs = 0, gestureLatMaxMs = 0;
+  uint64_t stateMs[4] = { 0, 0, 0, 0 };
+  uint64_t holdSumMs = 0, holdMaxMs = 0;
+  uint32_t holdHist[HOLD_BINS] = { 0 };
+  double   fatigueSlopeSum = 0;    // grip-weighted, % per hour
+  uint64_t fatigueGrips = 0;
+  double   cpuSec = 0;
+
+  void add(const Totals &o) {
+    sessions += o.sessions; failed += o.failed; samples += o.samples;
+    grips += o.grips; holds += o.holds; falseAct += o.falseAct; missed += o.missed;
+    labelled += o.labelled; labels += o.labels; overruns += o.overruns;
+    gestures += o.gestures; doubles += o.doubles;
+    gestureHits += o.gestureHits; falseGestures += o.falseGestures;
+    gestureLatSumMs += o.gestureLatSumMs;
+    gestureLatMaxMs = std::max(gestureLatMaxMs, o.gestureLatMaxMs);
+    for (int i = 0; i < 4; i++) stateMs[i] += o.stateMs[i];
+    holdSumMs += o.holdSumMs;
+    holdMaxMs = std::max(holdMaxMs, o.holdMaxMs);
+    for (int i = 0; i < HOLD_BINS; i++) holdHist[i] += o.holdHist[i];
+    fatigueSlopeSum += o.fatigueSlopeSum;
+    fatigueGrips += o.fatigueGrips;
+    cpuSec += o.cpuSec;
+  }
+};
+
+// Least-squares slope of per-grip mean holding RMS over time
+struct Trend {
+  double n = 0, st = 0, sy = 0, stt = 0, sty = 0;
+  void add(double t, double y) { n++; st += t; sy += y; stt += t * t; sty += t * y; }
+  // Relative slope in % of mean level per hour
+  double slopePctPerHour() const {
+    double d = n * stt - st * st;
+    if (n < 3 || d <= 0 || sy <= 0) return 0;
+    double slope = (n * sty - st * sy) / d;
+    return 100.0 * slope / (sy / n);
+  }
+};
+
+struct Corpus {
+  std::vector<std::string> files;
+  unsigned long loopCostUs = 20;
+  FILE *csv = nullptr;
+  std::mutex csvM;
+};
+
+// ===================================================
+//  STREAMING ADC SOURCE
+// ===================================================
+struct Stream {
+  uint16_t buf[BLOCK_SAMPLES];
+  uint64_t base = 0;
+  size_t   count = 0;
+};
+
+// Tick i (1-based) delivers recorded sample i - 1
+static int streamSource(unsigned long index, void *ctx) {
+  const Stream *s = (const Stream *)ctx;
+  uint64_t k = (uint64_t)index - 1;
+  if (k < s->base || k >= s->base + s->count) return (int)(ADC_MAX / 2);
+  return s->buf[k - s->base];
+}
+
+// Pairs detections with double flexes in the labels, in order
+static void scoreGestures(const std::vector<SessionLabel> &labels,
+                          const std::vector<uint64_t> &detections, Totals &t) {
+  size_t d = 0;
+  for (size_t i = 0; i + 1 < labels.size(); i++) {
+    if (labels[i + 1].onset - labels[i].offset >= GESTURE_TRUTH_GAP_MS) continue;
+    uint64_t endMs = labels[i + 1].offset + 1;
+    t.doubles++;
+    while (d < detections.size() && detections[d] < labels[i + 1].onset + 1) {
+      t.falseGestures++;
+      d++;
+    }
+    if (d < detections.size() && detections[d] <= endMs + GESTURE_MATCH_MS) {
+      uint64_t lat = detections[d] > endMs ? detections[d] - endMs : 0;
+      t.gestureHits++;
+      t.gestureLatSumMs += lat;
+      t.gestureLatMaxMs = std::max(t.gestureLatMaxMs, lat);
+      d++;
+    }
+    i++;
+  }
+  t.falseGestures += detections.size() - d;
+}
+
+static double threadCpuSec() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ===================================================
+//  ONE SESSION
+// ===================================================
+static void analyse(Corpus *corpus, const std::string &path, Totals &out) {
+  double cpu0 = threadCpuSec();
+  Totals t;
+  t.sessions = 1;
+
+  SessionReader reader;
+  if (!reader.open(path.c_str())) {
+    fprintf(stderr, "skipping %s: not a session file\n", path.c_str());
+    out.failed++;
+    out.sessions++;
+    return;
+  }
+  const SessionHeader &hdr = reader.header();
+  if (hdr.sampleRateHz != SAMPLE_RATE_HZ) {
+    fprintf(stderr, "skipping %s: %u Hz (firmware runs at %d Hz)\n",
+            path.c_str(), hdr.sampleRateHz, SAMPLE_RATE_HZ);
+    out.failed++;
+    out.sessions++;
+    return;
+  }
+
+  // Ground truth, if present: at most one contraction per second
+  std::vector<SessionLabel> labels(hdr.samples / SAMPLE_RATE_HZ + 16);
+  long nLabels = sessionReadLabels(path.c_str(), labels.data(), labels.size());
+  bool haveLabels = nLabels >= 0;
+  if (nLabels > (long)labels.size()) {
+    fprintf(stderr, "%s: %ld labels, scoring the first %zu\n",
+            path.c_str(), nLabels, labels.size());
+    nLabels = (long)labels.size();
+  }
+  labels.resize(haveLabels ? nLabels : 0);
+  std::vector<bool> hit(labels.size(), false);
+  size_t labelIdx = 0;
+
+  Stream stream;
+  gripPowerOn();
+  simReset();
+  simSetLoopCostUs(corpus->loopCostUs);
+  simSetAdcSource(streamSource, &stream);
+  simMuteUart(true);
+  simTraceServos(false);
+  gripRestore();
+  simRunUntilMs(1);
+
+  int      state = (int)handState;
+  uint64_t holdStart = 0;
+  double   gripRms = 0;
+  uint64_t gripRmsN = 0;
+  Trend    trend;
+  uint32_t gestureSeen = 0;
+  std::vector<uint64_t> gestureMs;
+
+  for (;;) {
+    stream.base += stream.count;
+    stream.count = reader.read(stream.buf, BLOCK_SAMPLES);
+    if (stream.count == 0) break;
+
+    for (size_t i = 0; i < stream.count; i++) {
+      uint64_t k = stream.base + i;
+      simRunUntilMs((unsigned long)(k + 2));
+      uint64_t ms = k + 1;
+
+      if (gestureStats().detections != gestureSeen) {
+        gestureSeen = gestureStats().detections;
+        gestureMs.push_back(ms);
+      }
+
+      int now = (int)handState;
+      t.stateMs[now]++;
+      if (now == HOLDING) { gripRms += rmsValue; gripRmsN++; }
+      if (now == state) continue;
+
+      if (state == IDLE && now == CLOSING) {
+        t.grips++;
+        // Active if inside a labelled contraction (plus release slack)
+        while (labelIdx < labels.size() &&
+               labels[labelIdx].offset + 1 + RELEASE_MS < ms) labelIdx++;
+        if (labelIdx < labels.size() && labels[labelIdx].onset + 1 <= ms) hit[labelIdx] = true;
+        else if (haveLabels) t.falseAct++;
+      }
+      if (now == HOLDING) {
+        holdStart = ms;
+        gripRms = 0;
+        gripRmsN = 0;
+      }
+      if (state == HOLDING) {
+        uint64_t held = ms - holdStart;
+        t.holds++;
+        t.holdSumMs += held;
+        t.holdMaxMs = std::max(t.holdMaxMs, held);
+        t.holdHist[std::min<uint64_t>(held / HOLD_BIN_MS, HOLD_BINS - 1)]++;
+        if (gripRmsN) trend.add(ms / 3600000.0, gripRms / gripRmsN);
+      }
+      state = now;
+    }
+    simClearTraces();
+  }
+
+  t.samples  = stream.base;
+  t.overruns = simMissedSamples();
+  if (haveLabels) {
+    t.labelled = 1;
+    t.labels   = labels.size();
+    t.missed   = std::count(hit.begin(), hit.end(), false);
+    scoreGestures(labels, gestureMs, t);
+  }
+  t.gestures = gestureMs.size();
+  t.fatigueGrips    = (uint64_t)trend.n;
+  t.fatigueSlopeSum = trend.slopePctPerHour() * trend.n;
+  t.cpuSec          = threadCpuSec() - cpu0;
+
+  if (corpus->csv) {
+    double hours = t.samples / (3600.0 * SAMPLE_RATE_HZ);
+    std::lock_guard<std::mutex> lk(corpus->csvM);
+    fprintf(corpus->csv, "%s,%.4f,%llu,%.1f,%.0f,%lld,%lld,%.2f,%llu,%llu,%lld\n",
+            path.c_str(), hours, (unsigned long long)t.grips,
+            hours > 0 ? t.grips / hours : 0.0,
+            t.holds ? (double)t.holdSumMs / t.holds : 0.0,
+            haveLabels ? (long long)t.falseAct : -1LL,
+            haveLabels ? (long long)t.missed : -1LL,
+            trend.slopePctPerHour(), (unsigned long long)t.overruns,
+            (unsigned long long)t.gestures,
+            haveLabels ? (long long)t.falseGestures : -1LL);
+  }
+  out.add(t);
+}
+
+// ===================================================
+//  CORPUS
+// ===================================================
+static bool endsWith(const std::string &s, const char *suffix) {
+  size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static void collect(const char *arg, std::vector<std::string> &files) {
+  struct stat st;
+  if (stat(arg, &st) != 0) { fprintf(stderr, "cannot open %s\n", arg); return; }
+  if (!S_ISDIR(st.st_mode)) { files.push_back(arg); return; }
+  DIR *d = opendir(arg);
+  if (!d) return;
+  while (dirent *e = readdir(d)) {
+    std::string p = std::string(arg) + "/" + e->d_name;
+    if (e->d_name[0] == '.') continue;
+    if (endsWith(p, ".ses")) files.push_back(p);
+    else if (stat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) collect(p.c_str(), files);
+  }
+  closedir(d);
+}
+
+// Linear within the bin that holds the rank, never past the longest
+// hold; the overflow bin spans up to it
+static double percentileMs(const Totals &t, double q) {
+  uint64_t want = (uint64_t)ceil(q * t.holds), seen = 0;
+  for (int i = 0; i < HOLD_BINS; i++) {
+    uint32_t n = t.holdHist[i];
+    if (seen + n >= want && n > 0) {
+      double lo = (double)i * HOLD_BIN_MS;
+      double hi = i == HOLD_BINS - 1 ? (double)t.holdMaxMs : lo + HOLD_BIN_MS;
+      double ms = lo + (hi - lo) * (double)(want - seen) / n;
+      return std::min(ms, (double)t.holdMaxMs);
+    }
+    seen += n;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  Corpus corpus;
+  unsigned threads = 0;
+  const char *csvPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if      (!strcmp(argv[i], "--threads") && more) threads = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--loop-us") && more) corpus.loopCostUs = atol(argv[++i]);
+    else if (!strcmp(argv[i], "--csv") && more)     csvPath = argv[++i];
+    else collect(argv[i], corpus.files);
+  }
+  if (corpus.files.empty()) {
+    fprintf(stderr, "usage: batch <dir|file.ses>... [--threads T] [--loop-us N] [--csv FILE]\n");
+    return 2;
+  }
+  if (csvPath) {
+    corpus.csv = fopen(csvPath, "w");
+    if (!corpus.csv) { fprintf(stderr, "cannot write %s\n", csvPath); return 2; }
+    fprintf(corpus.csv, "session,hours,grips,grips_per_hour,mean_hold_ms,"
+                        "false_activations,missed,fatigue_pct_per_hour,overruns,"
+                        "gestures,false_gestures\n");
+  }
+
+  // Largest sessions first so stragglers are small
+  std::vector<std::pair<off_t, std::string>> bySize;
+  for (const std::string &f : corpus.files) {
+    struct stat st;
+    bySize.push_back({ stat(f.c_str(), &st) == 0 ? st.st_size : 0, f });
+  }
+  std::sort(bySize.begin(), bySize.end(),
+            [](const std::pair<off_t, std::string> &a, const std::pair<off_t, std::string> &b) {
+              return a.first > b.first;
+            });
+
+  configBegin("");   // replay never touches persisted config
+
+  auto t0 = std::chrono::steady_clock::now();
+  WorkPool pool(threads);
+  std::vector<Totals> perWorker(pool.size());
+  for (auto &entry : bySize) {
+    const std::string *path = &entry.second;
+    pool.submit([&corpus, &perWorker, path](unsigned w) { analyse(&corpus, *path, perWorker[w]); });
+  }
+  pool.wait();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (corpus.csv) fclose(corpus.csv);
+
+  Totals all;
+  for (const Totals &w : perWorker) all.add(w);
+  double hours = all.samples / (3600.0 * SAMPLE_RATE_HZ);
+  double stateTotal = all.stateMs[0] + all.stateMs[1] + all.stateMs[2] + all.stateMs[3];
+  if (stateTotal <= 0) stateTotal = 1;
+
+  printf("%-28s %s\n", "metric", "value");
+  printf("%-28s %llu (%llu failed)\n", "sessions", (unsigned long long)all.sessions,
+         (unsigned long long)all.failed);
+  printf("%-28s %.2f\n", "hours", hours);
+  printf("%-28s %llu\n", "grips", (unsigned long long)all.grips);
+  printf("%-28s %.1f\n", "grips per hour", hours > 0 ? all.grips / hours : 0.0);
+  printf("%-28s %.0f / %.0f / %.0f / %.0f / %llu\n", "hold ms mean/p50/p90/p99/max",
+         all.holds ? (double)all.holdSumMs / all.holds : 0.0,
+         percentileMs(all, 0.50), percentileMs(all, 0.90), percentileMs(all, 0.99),
+         (unsigned long long)all.holdMaxMs);
+  printf("%-28s %.1f / %.1f / %.1f / %.1f\n", "time in state % I/C/H/O",
+         100 * all.stateMs[IDLE] / stateTotal, 100 * all.stateMs[CLOSING] / stateTotal,
+         100 * all.stateMs[HOLDING] / stateTotal, 100 * all.stateMs[OPENING] / stateTotal);
+  if (all.labelled)
+    printf("%-28s %llu false, %llu of %llu missed (%llu labelled sessions)\n", "activations vs labels",
+           (unsigned long long)all.falseAct, (unsigned long long)all.missed,
+           (unsigned long long)all.labels, (unsigned long long)all.labelled);
+  else
+    printf("%-28s n/a (no label files)\n", "activations vs labels");
+  if (all.labelled)
+    printf("%-28s %llu of %llu double flexes, %llu false (%.2f / hour)\n", "gestures vs labels",
+           (unsigned long long)all.gestureHits, (unsigned long long)all.doubles,
+           (unsigned long long)all.falseGestures, hours > 0 ? all.falseGestures / hours : 0.0);
+  else
+    printf("%-28s %llu (no label files)\n", "gestures", (unsigned long long)all.gestures);
+  printf("%-28s %.0f / %llu\n", "gesture latency ms mean/max",
+         all.gestureHits ? (double)all.gestureLatSumMs / all.gestureHits : 0.0,
+         (unsigned long long)all.gestureLatMaxMs);
+  printf("%-28s %+.2f\n", "fatigue trend %/hour",
+         all.fatigueGrips ? all.fatigueSlopeSum / all.fatigueGrips : 0.0);
+  printf("%-28s %.4f%% (%llu samples)\n", "sample overrun rate",
+         all.samples ? 100.0 * all.overruns / all.samples : 0.0, (unsigned long long)all.overruns);
+  printf("%-28s %.2f s wall, %.2f s cpu, %u threads, %.0f%% efficiency, %llu steals\n", "run",
+         wall, all.cpuSec, pool.size(), wall > 0 ? 100.0 * all.cpuSec / (wall * pool.size()) : 0.0,
+         (unsigned long long)pool.steals());
+  printf("%-28s %.1f Msamples/s (%.0fx real time)\n", "throughput",
+         wall > 0 ? all.samples / wall / 1e6 : 0.0, wall > 0 ? hours * 3600 / wall : 0.0);
+  return all.failed ? 1 : 0;
+}
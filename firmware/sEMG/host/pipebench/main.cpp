@@ -0,0 +1,236 @@
+// ===================================================
+//  sEMG GRIP — PIPELINE BENCHMARK
+//
+//  Runs the hand-written reference chain (the
+//  firmware's processEMG() before lib/Pipeline) and a
+//  list of compile-time pipelines over the same ADC
+//  stream and reports ns/sample, the largest
+//  difference from the reference RMS and how often
+//  the raw threshold decision disagrees.
+//
+//  The firmware chain, processEMG() running its
+//  EmgPipeline, must match the reference bit for bit;
+//  the exit code is 1 if it does not. To try a
+//  configuration, add a line to
+//  EXPERIMENTS below. The "no quality gate" and
+//  "+ quality" rows price the signal-quality tap.
+//
+//  usage: pipebench [file.ses...] [options]
+//    --seconds S   synthetic stream length   (default 600)
+//    --seed X      synthetic stream seed     (default 1)
+//    --repeat R    timed runs, best is kept  (default 5)
+// ===================================================
+#include <EmgSynth.h>
+#include <GripControl.h>
+#include <Pipeline.h>
+#include <SessionFile.h>
+#include <SimHal.h>   // HAL for the linked control code
+
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+#define BLOCK_SAMPLES 65536
+
+struct Stream {
+  std::vector<uint16_t> adc;
+  std::vector<float>    ref;       // reference chain RMS
+  double refNs = 0;
+};
+
+struct Result {
+  const char *name;
+  double ns;
+  float  maxDiff;
+  double disagree;                 // fraction of decisions
+};
+
+static double nowNs() {
+  return std::chrono::duration<double, std::nano>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void loadStream(Stream &s, int argc, char **argv, double seconds, uint64_t seed) {
+  std::vector<uint16_t> buf(BLOCK_SAMPLES);
+  for (int i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') { i++; continue; }
+    SessionReader reader;
+    if (!reader.open(argv[i])) { fprintf(stderr, "cannot read %s\n", argv[i]); continue; }
+    while (size_t n = reader.read(buf.data(), buf.size()))
+      s.adc.insert(s.adc.end(), buf.begin(), buf.begin() + n);
+  }
+  if (!s.adc.empty()) return;
+
+  EmgSynthConfig cfg;
+  cfg.seed = seed;
+  EmgSynth synth(cfg);
+  s.adc.resize((size_t)(seconds * cfg.sampleRateHz));
+  synth.generate(s.adc.data(), s.adc.size());
+}
+
+// ===================================================
+//  REFERENCE — the hand-written chain, kept verbatim
+// ===================================================
+struct Reference {
+  float rmsBuffer[WINDOW_SIZE];
+  int   rmsIndex;
+  float hp_in, hp_out;
+  float lp_state;
+  float rms;
+};
+
+static float highPass(Reference &d, float in) {
+  const float a = gripParams.hpAlpha;
+  float out = a * (d.hp_out + in - d.hp_in);
+  d.hp_in  = in;
+  d.hp_out = out;
+  return out;
+}
+static float lowPass(Reference &d, float in) {
+  const float a = gripParams.lpAlpha;
+  d.lp_state = a * d.lp_state + (1.0f - a) * in;
+  return d.lp_state;
+}
+static float computeRMS(const Reference &d) {
+  float sum = 0;
+  for (int i = 0; i < WINDOW_SIZE; i++)
+    sum += d.rmsBuffer[i] * d.rmsBuffer[i];
+  return sqrtf(sum / WINDOW_SIZE);
+}
+static float referenceEMG(Reference &d, int adc) {
+  float v  = adcToVolts(adc);
+  float hp = highPass(d, v);
+  sqSample(adc, v, hp);
+  float lp = lowPass(d, hp);
+  d.rmsBuffer[d.rmsIndex] = lp;
+  d.rmsIndex = (d.rmsIndex + 1) % WINDOW_SIZE;
+  if (sqGood()) d.rms = computeRMS(d);
+  return d.rms;
+}
+
+// processEMG() itself, shaped like a Pipeline for bench()
+struct FirmwareChain {
+  inline float operator()(int adc) { processEMG(adc); return rmsValue; }
+  template <class In, class Out>
+  void block(const In *in, size_t n, Out *out) {
+    for (size_t i = 0; i < n; i++) out[i] = (*this)(in[i]);
+  }
+  void reset() {}   // gripPowerOn() resets the DSP store
+};
+
+// ===================================================
+//  RUNS
+// ===================================================
+static void runReference(Stream &s, int repeat) {
+  s.ref.resize(s.adc.size());
+  double best = 1e300;
+  for (int r = 0; r < repeat; r++) {
+    gripPowerOn();
+    Reference d = {};
+    double t0 = nowNs();
+    for (size_t i = 0; i < s.adc.size(); i++) s.ref[i] = referenceEMG(d, s.adc[i]);
+    double t = nowNs() - t0;
+    if (t < best) best = t;
+  }
+  s.refNs = best / s.adc.size();
+}
+
+template <class Pipe>
+static Result bench(const char *name, const Stream &s, int repeat) {
+  typedef decltype(std::declval<Pipe &>()(0)) Out;
+  std::unique_ptr<Out[]> out(new Out[s.adc.size()]);
+  Pipe pipe;
+
+  double best = 1e300;
+  for (int r = 0; r < repeat; r++) {
+    gripPowerOn();
+    pipe.reset();
+    double t0 = nowNs();
+    pipe.block(s.adc.data(), s.adc.size(), out.get());
+    double t = nowNs() - t0;
+    if (t < best) best = t;
+  }
+
+  Result res = { name, best / s.adc.size(), 0, 0 };
+  size_t disagree = 0;
+  for (size_t i = 0; i < s.adc.size(); i++) {
+    bool refHit = s.ref[i] > DEFAULT_THRESHOLD;
+    if constexpr (std::is_same<Out, bool>::value) {
+      disagree += out[i] != refHit;
+    } else {
+      float d = fabsf(out[i] - s.ref[i]);
+      if (d > res.maxDiff) res.maxDiff = d;
+      disagree += (out[i] > DEFAULT_THRESHOLD) != refHit;
+    }
+  }
+  res.disagree = (double)disagree / s.adc.size();
+  return res;
+}
+
+// ===================================================
+//  EXPERIMENTS — one line each
+// ===================================================
+typedef HighPass<Coef<9747>> Hp;
+typedef LowPass<Coef<7000>>  Lp;
+typedef QualityHighPass<Coef<9747>> QHp;
+
+static std::vector<Result> runExperiments(const Stream &s, int repeat) {
+  return {
+    bench<FirmwareChain>                                        ("firmware chain", s, repeat),
+    bench<EmgPipeline>                                          ("EmgPipeline", s, repeat),
+    bench<Pipeline<AdcVolts, HighPass<TunedHp>, LowPass<TunedLp>,
+                   RmsWindow<WINDOW_SIZE>>>                     ("no quality gate", s, repeat),
+    bench<Pipeline<AdcVolts, Hp, Lp, RmsWindow<WINDOW_SIZE>>>   ("const coefs", s, repeat),
+    bench<Pipeline<AdcVolts, Hp, Lp, RunningRms<WINDOW_SIZE>>>  ("running rms", s, repeat),
+    bench<Pipeline<QualityVolts, QHp, Lp, RunningRms<WINDOW_SIZE>>>("running rms + quality", s, repeat),
+    bench<Pipeline<AdcVolts, Hp, Lp, RunningRms<100>>>          ("running rms 100", s, repeat),
+    bench<Pipeline<AdcVolts, Hp, RunningRms<WINDOW_SIZE>>>      ("no low-pass", s, repeat),
+    bench<Pipeline<AdcVolts, Hp, Lp, RunningRms<WINDOW_SIZE>, Above>>("running rms detector", s, repeat),
+  };
+}
+
+// ===================================================
+//  MAIN
+// ===================================================
+int main(int argc, char **argv) {
+  double   seconds = 600;
+  uint64_t seed = 1;
+  int      repeat = 5;
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if      (!strcmp(argv[i], "--seconds") && more) seconds = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && more)    seed = strtoull(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--repeat") && more)  repeat = atoi(argv[++i]);
+    else if (argv[i][0] == '-') {
+      fprintf(stderr, "unknown option %s (see header of host/pipebench/main.cpp)\n", argv[i]);
+      return 2;
+    }
+  }
+  if (repeat < 1) repeat = 1;
+
+  Stream s;
+  loadStream(s, argc, argv, seconds, seed);
+  if (s.adc.empty()) { fprintf(stderr, "no samples\n"); return 2; }
+  runReference(s, repeat);
+
+  printf("%zu samples, best of %d runs\n\n", s.adc.size(), repeat);
+  printf("%-24s %9s %8s %11s %10s\n", "pipeline", "ns/sample", "speedup", "max |diff|", "disagree");
+  printf("%-24s %9.2f %8s %11s %10s\n", "reference", s.refNs, "1.00x", "-", "-");
+
+  int failed = 0;
+  std::vector<Result> results = runExperiments(s, repeat);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &r = results[i];
+    printf("%-24s %9.2f %7.2fx %11.2e %9.4f%%\n", r.name, r.ns, s.refNs / r.ns,
+           r.maxDiff, 100.0 * r.disagree);
+    // results[0] is processEMG()
+    if (i == 0 && r.maxDiff != 0) failed = 1;
+  }
+  if (failed) printf("\nFAIL: processEMG() differs from the reference chain\n");
+  return failed;
+}
@@ -0,0 +1,654 @@
+// ===================================================
+//  sEMG GRIP — VIRTUAL-TIME SIMULATOR
+//
+//  Runs the firmware control loop (lib/GripControl)
+//  against a fake ADC, servo bank and UART, driven by
+//  a scenario script. Expectations in the script are
+//  checked against the recorded traces; the exit code
+//  is the number of failed expectations.
+//
+//  With --pty the scenario runs in real time instead,
+//  streaming the UART to a pseudo-terminal and taking
+//  key presses from it, so desktop tools can connect
+//  to the simulator as if it were the arm.
+//
+//  "adc_model" bends the fake ADC like a real ESP32
+//  channel; "adc_cal sweep" then characterizes it the
+//  way a bench sweep would before the run starts.
+//  "adc_cal bench <ms> [step_mv]" plays the bench
+//  instead: from ms on it steps the input from 0 V to
+//  VREF, holding each step BENCH_HOLD_MS, and types
+//  the firmware's 'b' sweep protocol on the UART.
+//
+//  "object <angle> [amps_per_deg]" puts an object in
+//  the hand: past that servo angle each servo's supply
+//  current rises with the squeeze, like a servo
+//  pushing against it. It also fits the current
+//  sensor, as FORCE_SENSOR does on the board; without
+//  it the estimator stays idle.
+//
+//  "telem <field> last|minmax|lttb" sets a field's
+//  telemetry decimation. "expect_rms_peaks <level>
+//  <tol>" checks that every excursion of the real RMS
+//  above level shows in the Teleplot stream (">rms:"
+//  or ">rms_max:") within tol ms of its end. Only
+//  minmax guarantees that; LTTB keeps the shape.
+//
+//  "expect_angle <ms> <angle> [channel]" checks one
+//  servo (default channel 0, the thumb).
+//
+//  "actuators direct|pca9685 [hz]" picks the servo
+//  backend (lib/Actuators); pca9685 runs on the fake
+//  I2C bus. "expect_i2c <per_ms> <us>" checks that no
+//  millisecond after setup saw more than per_ms
+//  transactions and none held the bus longer than us.
+//
+//  "lead <ms> ok|off|rail" scripts the electrode: off
+//  parks the input at MIDPOINT with no noise at all,
+//  rail pins it at VREF, ok reconnects it.
+//
+//  "loop_us <us> [from_ms]" sets what a loop pass
+//  costs, from the start or from from_ms on.
+//  "reboot <ms>" power-cycles the firmware: state is
+//  reset and restored from config as setup() does.
+//  Neither applies in --pty mode.
+//
+//  usage: sim <scenario> [--trace file.csv] [--log] [--pty]
+// ===================================================
+#include <Actuators.h>
+#include <AdcCal.h>
+#include <ConfigStore.h>
+#include <FingerCal.h>
+#include <GripForce.h>
+#include <GripControl.h>
+#include <Hal.h>
+#include <SimHal.h>
+#include <Teleplot.h>
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// ===================================================
+//  FAKE EMG SOURCE
+//  Rest noise plus a muscle burst whose amplitude is
+//  scripted over time. Every sample is a pure function
+//  of (seed, index) so runs are bit-reproducible.
+// ===================================================
+struct EmgSegment {
+  unsigned long ms;
+  float amp;
+};
+
+enum LeadState { LEAD_OK, LEAD_OFF, LEAD_RAIL };
+
+struct LeadSegment {
+  unsigned long ms;
+  LeadState state;
+};
+
+// Non-ideal ADC transfer: gain error, offset and a bow
+// that peaks mid-scale, as on the ESP32 at 11 dB
+struct AdcModel {
+  float gain = 1.0f;
+  float offsetMv = 0;
+  float bowMv = 0;
+};
+
+#define BENCH_HOLD_MS  100
+#define BENCH_TYPE_MS  10     // into a step, when its mV are sent
+
+struct EmgScript {
+  uint64_t seed = 1;
+  float    noise = 0.01f;
+  AdcModel adc;
+  long     benchMs = -1;      // on-device sweep from here
+  int      benchStepMv = 50;
+  std::vector<EmgSegment> segments;
+  std::vector<LeadSegment> leads;
+};
+
+static uint64_t splitmix64(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+static float gaussian(uint64_t key) {
+  uint64_t r = splitmix64(key);
+  float u1 = ((r >> 40) + 1) * (1.0f / 16777217.0f);
+  float u2 = ((r >> 16) & 0xFFFFFF) * (1.0f / 16777216.0f);
+  return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+static int adcCode(const AdcModel &m, float v) {
+  float x  = v / VREF;
+  float mv = m.offsetMv + m.bowMv * 4.0f * x * (1.0f - x);
+  int adc = (int)lroundf((m.gain * x + mv / 1000.0f / VREF) * ADC_MAX);
+  if (adc < 0) adc = 0;
+  if (adc > (int)ADC_MAX) adc = (int)ADC_MAX;
+  return adc;
+}
+
+static unsigned long benchSteps(const EmgScript &s) {
+  return (unsigned long)(VREF * 1000) / s.benchStepMv + 1;
+}
+
+static int emgSource(unsigned long index, void *ctx) {
+  const EmgScript *s = (const EmgScript *)ctx;
+  if (s->benchMs >= 0 && index >= (unsigned long)s->benchMs) {
+    unsigned long step = (index - s->benchMs) / BENCH_HOLD_MS;
+    if (step < benchSteps(*s))
+      return adcCode(s->adc, step * s->benchStepMv / 1000.0f + s->noise * gaussian(index));
+  }
+  float amp = 0;
+  for (const EmgSegment &seg : s->segments)
+    if (seg.ms <= index) amp = seg.amp;
+  LeadState lead = LEAD_OK;
+  for (const LeadSegment &seg : s->leads)
+    if (seg.ms <= index) lead = seg.state;
+  if (lead == LEAD_OFF) return adcCode(s->adc, MIDPOINT);
+  uint64_t key = s->seed * 0x100000001B3ULL + index;
+  float v = MIDPOINT + s->noise * gaussian(key) + amp * gaussian(~key);
+  if (lead == LEAD_RAIL) v = VREF + s->noise * gaussian(key);
+  return adcCode(s->adc, v);
+}
+
+// ===================================================
+//  FAKE SERVO CURRENT
+//  Idle draw per servo, plus a squeeze current once a
+//  finger presses past the object, up to stall.
+// ===================================================
+#define SERVO_IDLE_A   0.08f
+#define SERVO_STALL_A  1.5f
+#define CURRENT_NOISE_A 0.02f
+
+struct ServoLoad {
+  int   objectAngle = -1;       // none
+  float ampsPerDeg  = 0.03f;
+};
+
+struct CurrentCtx {
+  const ServoLoad *load;
+  const EmgScript *emg;
+};
+
+static int currentSource(unsigned long index, const int *servos, void *ctx) {
+  const CurrentCtx *c = (const CurrentCtx *)ctx;
+  float amps = 0;
+  for (int i = 0; i < NUM_FINGERS; i++) {
+    float squeeze = c->load->ampsPerDeg * (servos[i] - c->load->objectAngle);
+    if (squeeze < 0) squeeze = 0;
+    if (squeeze > SERVO_STALL_A) squeeze = SERVO_STALL_A;
+    amps += SERVO_IDLE_A + squeeze;
+  }
+  uint64_t key = (c->emg->seed ^ 0xC0FFEEULL) * 0x100000001B3ULL + index;
+  amps += CURRENT_NOISE_A * gaussian(key);
+  return adcCode(c->emg->adc, amps * FORCE_V_PER_A);
+}
+
+// Step the input over the full range in 10 mV steps
+static bool sweepAdc(const AdcModel &m) {
+  std::vector<int>   codes;
+  std::vector<float> volts;
+  for (int mv = 0; mv <= (int)(VREF * 1000); mv += 10) {
+    volts.push_back(mv / 1000.0f);
+    codes.push_back(adcCode(m, mv / 1000.0f));
+  }
+  return adcCalFromSweep(codes.data(), volts.data(), (int)codes.size());
+}
+
+// The bench side of the 'b' protocol: start, one mV line per
+// step once it has settled, then fit and save
+static void benchKeys(const EmgScript &s, std::vector<std::pair<unsigned long, char>> &keys) {
+  unsigned long t0 = (unsigned long)s.benchMs;
+  keys.push_back({ t0, 'b' });
+  for (unsigned long k = 0; k < benchSteps(s); k++) {
+    char mv[16];
+    snprintf(mv, sizeof(mv), "%lu\n", k * s.benchStepMv);
+    for (const char *c = mv; *c; c++) keys.push_back({ t0 + k * BENCH_HOLD_MS + BENCH_TYPE_MS, *c });
+  }
+  keys.push_back({ t0 + benchSteps(s) * BENCH_HOLD_MS, 'b' });
+}
+
+// ===================================================
+//  SCENARIO
+// ===================================================
+enum ExpectKind { EXPECT_LOG, EXPECT_ANGLE, EXPECT_STATE, EXPECT_RMS_PEAKS, EXPECT_I2C };
+
+struct Expect {
+  ExpectKind  kind;
+  unsigned long ms;
+  unsigned long tol;
+  int         value;
+  std::string text;
+  int         line;
+  float       level = 0;
+  int         ch = 0;         // servo channel for EXPECT_ANGLE
+};
+
+#define SIM_REBOOT  -1L
+
+struct Scenario {
+  EmgScript emg;
+  ServoLoad load;
+  unsigned long loopCostUs = 20;
+  // (ms, new loop cost in us or SIM_REBOOT)
+  std::vector<std::pair<unsigned long, long>> events;
+  ActBackend backend = ACT_DIRECT;
+  unsigned long i2cHz = ACT_I2C_HZ;
+  unsigned long runMs = 0;
+  bool warm = false;
+  bool adcSweep = false;
+  std::vector<std::pair<unsigned long, char>> keys;
+  std::vector<std::pair<int, TelemDecim>> decim;
+  std::vector<Expect> expects;
+};
+
+static const char *STATE_NAMES[] = { "IDLE", "CLOSING", "HOLDING", "OPENING" };
+
+static const char *FIELD_NAMES[] = { "rms", "threshold", "muscle", "angle", "state", "current" };
+static const char *DECIM_NAMES[] = { "last", "minmax", "lttb" };
+static const char *LEAD_NAMES[]  = { "ok", "off", "rail" };
+static const char *BACKEND_NAMES[] = { "direct", "pca9685" };
+
+static int parseName(const char *s, const char *const *names, int n) {
+  for (int i = 0; i < n; i++)
+    if (strcmp(s, names[i]) == 0) return i;
+  return -1;
+}
+
+static int parseState(const char *s) {
+  for (int i = 0; i < 4; i++)
+    if (strcmp(s, STATE_NAMES[i]) == 0) return i;
+  return -1;
+}
+
+static bool loadScenario(const char *path, Scenario &sc) {
+  FILE *f = fopen(path, "r");
+  if (!f) { fprintf(stderr, "cannot open %s\n", path); return false; }
+
+  char line[256];
+  int lineNo = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    char cmd[32];
+    int used = 0;
+    if (sscanf(line, "%31s%n", cmd, &used) != 1) continue;
+    const char *args = line + used;
+
+    unsigned long t = 0, tol = 0;
+    float amp = 0;
+    int n = 0;
+    char word[32], word2[32];
+
+    if (strcmp(cmd, "seed") == 0 && sscanf(args, "%lu", &t) == 1) {
+      sc.emg.seed = t;
+    } else if (strcmp(cmd, "noise") == 0 && sscanf(args, "%f", &amp) == 1) {
+      sc.emg.noise = amp;
+    } else if (strcmp(cmd, "loop_us") == 0 && (n = sscanf(args, "%lu %lu", &t, &tol)) >= 1) {
+      if (n == 2) sc.events.push_back({ tol, (long)t });
+      else        sc.loopCostUs = t;
+    } else if (strcmp(cmd, "reboot") == 0 && sscanf(args, "%lu", &t) == 1) {
+      sc.events.push_back({ t, SIM_REBOOT });
+    } else if (strcmp(cmd, "adc_model") == 0 &&
+               sscanf(args, "%f %f %f", &sc.emg.adc.gain, &sc.emg.adc.offsetMv,
+                      &sc.emg.adc.bowMv) == 3) {
+    } else if (strcmp(cmd, "adc_cal") == 0 && sscanf(args, "%31s", word) == 1 &&
+               strcmp(word, "sweep") == 0) {
+      sc.adcSweep = true;
+    } else if (strcmp(cmd, "adc_cal") == 0 &&
+               (n = sscanf(args, "%31s %lu %lu", word, &t, &tol)) >= 2 &&
+               strcmp(word, "bench") == 0) {
+      sc.emg.benchMs = (long)t;
+      if (n == 3 && tol > 0) sc.emg.benchStepMv = (int)tol;
+      benchKeys(sc.emg, sc.keys);
+    } else if (strcmp(cmd, "object") == 0 &&
+               sscanf(args, "%d %f", &sc.load.objectAngle, &sc.load.ampsPerDeg) >= 1) {
+    } else if (strcmp(cmd, "warm") == 0) {
+      sc.warm = true;
+    } else if (strcmp(cmd, "emg") == 0 && sscanf(args, "%lu %f", &t, &amp) == 2) {
+      sc.emg.segments.push_back({ t, amp });
+    } else if (strcmp(cmd, "actuators") == 0 && sscanf(args, "%31s", word) == 1 &&
+               parseName(word, BACKEND_NAMES, 2) >= 0) {
+      sc.backend = (ActBackend)parseName(word, BACKEND_NAMES, 2);
+      sscanf(args, "%*s %lu", &sc.i2cHz);
+    } else if (strcmp(cmd, "lead") == 0 && sscanf(args, "%lu %31s", &t, word) == 2 &&
+               parseName(word, LEAD_NAMES, 3) >= 0) {
+      sc.emg.leads.push_back({ t, (LeadState)parseName(word, LEAD_NAMES, 3) });
+    } else if (strcmp(cmd, "telem") == 0 && sscanf(args, "%31s %31s", word, word2) == 2 &&
+               parseName(word, FIELD_NAMES, TELEM_DECIM_FIELDS) >= 0 &&
+               parseName(word2, DECIM_NAMES, 3) >= 0) {
+      sc.decim.push_back({ parseName(word, FIELD_NAMES, TELEM_DECIM_FIELDS),
+                           (TelemDecim)parseName(word2, DECIM_NAMES, 3) });
+    } else if (strcmp(cmd, "key") == 0 && sscanf(args, "%lu %31s", &t, word) == 2) {
+      sc.keys.push_back({ t, word[0] });
+    } else if (strcmp(cmd, "run") == 0 && sscanf(args, "%lu", &t) == 1) {
+      if (t > sc.runMs) sc.runMs = t;
+    } else if (strcmp(cmd, "expect_log") == 0 &&
+               sscanf(args, "%lu %lu %n", &t, &tol, &n) == 2 && n > 0) {
+      std::string text = args + n;
+      while (!text.empty() && (text.back() == '\n' || text.back() == ' ' || text.back() == '\r'))
+        text.pop_back();
+      sc.expects.push_back({ EXPECT_LOG, t, tol, 0, text, lineNo });
+    } else if (strcmp(cmd, "expect_angle") == 0 && sscanf(args, "%lu %d", &t, &n) == 2) {
+      int ch = 0;
+      sscanf(args, "%*u %*d %d", &ch);
+      sc.expects.push_back({ EXPECT_ANGLE, t, 0, n, "", lineNo, 0, ch });
+    } else if (strcmp(cmd, "expect_state") == 0 && sscanf(args, "%lu %31s", &t, word) == 2 &&
+               parseState(word) >= 0) {
+      sc.expects.push_back({ EXPECT_STATE, t, 0, parseState(word), word, lineNo });
+    } else if (strcmp(cmd, "expect_rms_peaks") == 0 &&
+               sscanf(args, "%f %lu", &amp, &tol) == 2) {
+      sc.expects.push_back({ EXPECT_RMS_PEAKS, 0, tol, 0, "rms peaks", lineNo, amp });
+    } else if (strcmp(cmd, "expect_i2c") == 0 && sscanf(args, "%d %lu", &n, &tol) == 2) {
+      sc.expects.push_back({ EXPECT_I2C, 0, tol, n, "i2c budget", lineNo });
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse '%s'\n", path, lineNo, cmd);
+      ok = false;
+    }
+  }
+  fclose(f);
+  return ok;
+}
+
+// ===================================================
+//  CHECKS
+// ===================================================
+static int angleAt(unsigned long ms, int ch) {
+  int angle = servoAngle;
+  bool seen = false;
+  for (const SimServoEvent &e : simServoTrace()) {
+    if (e.ch != ch) continue;
+    if (e.ms > ms) break;
+    angle = e.angle;
+    seen = true;
+  }
+  return seen ? angle : SERVO_OPEN;
+}
+
+static int stateAt(unsigned long ms, int initial) {
+  int state = initial;
+  for (const SimStateEvent &e : simStateTrace()) {
+    if (e.ms > ms) break;
+    state = e.state;
+  }
+  return state;
+}
+
+// Largest plotted RMS (mean, max or LTTB pick) sent in [fromMs, toMs]
+static float plottedRms(unsigned long fromMs, unsigned long toMs) {
+  float best = -1;
+  for (const SimLogLine &l : simLog()) {
+    if (l.ms < fromMs || l.ms > toMs) continue;
+    if (l.text.rfind(">rms:", 0) != 0 && l.text.rfind(">rms_max:", 0) != 0) continue;
+    float v = strtof(l.text.c_str() + l.text.rfind(':') + 1, nullptr);
+    if (v > best) best = v;
+  }
+  return best;
+}
+
+// Every excursion of the real RMS above e.level must be plotted
+// above it (less the 4-decimal rounding) before it ends + e.tol
+static bool checkRmsPeaks(const Expect &e, std::string &got) {
+  const std::vector<SimRmsEvent> &tr = simRmsTrace();
+  int excursions = 0, lost = 0;
+  char buf[96];
+  for (size_t i = 0; i < tr.size(); i++) {
+    if (tr[i].rms <= e.level) continue;
+    size_t j = i;
+    float peak = tr[i].rms;
+    while (j + 1 < tr.size() && tr[j + 1].rms > e.level) peak = fmaxf(peak, tr[++j].rms);
+    unsigned long endMs = j + 1 < tr.size() ? tr[j + 1].ms : tr[j].ms;
+    // Still open when the run ended: no frame could have shown it yet
+    if (endMs + e.tol > simNowUs() / 1000) break;
+    excursions++;
+    if (plottedRms(tr[i].ms, endMs + e.tol) < e.level - 0.00005f && lost++ == 0)
+      snprintf(buf, sizeof(buf), "peak %.4f at %lu-%lu ms", peak, tr[i].ms, endMs);
+    i = j;
+  }
+  if (excursions == 0) { got = "no excursions"; return false; }
+  if (lost == 0) return true;
+  got = std::to_string(lost) + "/" + std::to_string(excursions) + " lost, first " + buf;
+  return false;
+}
+
+// After setup (ms 0: expander init and the first write), no
+// millisecond with more than e.value transactions, none longer
+// than e.tol us, and the bus was used at all
+static bool checkI2c(const Expect &e, std::string &got) {
+  const std::vector<SimI2cEvent> &tr = simI2cTrace();
+  int most = 0, inMs = 0;
+  unsigned long ms = (unsigned long)-1, longest = 0;
+  for (const SimI2cEvent &t : tr) {
+    if (t.us < 1000) continue;
+    inMs = t.us / 1000 == ms ? inMs + 1 : 1;
+    ms = t.us / 1000;
+    if (inMs > most) most = inMs;
+    if (t.busUs > longest) longest = t.busUs;
+  }
+  char buf[96];
+  snprintf(buf, sizeof(buf), "%zu transactions, up to %d per ms, longest %lu us",
+           tr.size(), most, longest);
+  got = buf;
+  return !tr.empty() && most <= e.value && longest <= e.tol;
+}
+
+static bool check(const Expect &e, int initialState, std::string &got) {
+  char buf[64];
+  switch (e.kind) {
+    case EXPECT_LOG:
+      for (const SimLogLine &l : simLog()) {
+        if (l.text.find(e.text) == std::string::npos) continue;
+        if (l.ms >= e.ms && l.ms <= e.ms + e.tol) return true;
+        snprintf(buf, sizeof(buf), "at %lu ms", l.ms);
+        got = buf;
+      }
+      if (got.empty()) got = "never";
+      return false;
+    case EXPECT_ANGLE: {
+      int a = angleAt(e.ms, e.ch);
+      snprintf(buf, sizeof(buf), "%d", a);
+      got = buf;
+      return a == e.value;
+    }
+    case EXPECT_STATE: {
+      int s = stateAt(e.ms, initialState);
+      got = STATE_NAMES[s];
+      return s == e.value;
+    }
+    case EXPECT_RMS_PEAKS:
+      return checkRmsPeaks(e, got);
+    case EXPECT_I2C:
+      return checkI2c(e, got);
+  }
+  return false;
+}
+
+static void echoUart(const char *data, size_t len, void *) {
+  fwrite(data, 1, len, stdout);
+}
+
+// ===================================================
+//  REAL-TIME PTY MODE
+// ===================================================
+#define PTY_SLICE_MS 10
+
+static void ptyUart(const char *data, size_t len, void *ctx) {
+  int fd = *(int *)ctx;
+  // Nobody reading: drop output like an unplugged cable would
+  ssize_t n = write(fd, data, len);
+  (void)n;
+}
+
+static int openPty() {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+    fprintf(stderr, "cannot open pty: %s\n", strerror(errno));
+    if (fd >= 0) close(fd);
+    return -1;
+  }
+  // Raw line discipline so telemetry passes through untouched
+  int slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+  if (slave >= 0) {
+    termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+      cfmakeraw(&tio);
+      tcsetattr(slave, TCSANOW, &tio);
+    }
+    close(slave);
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+// Paces the virtual clock against the wall clock in
+// PTY_SLICE_MS steps; keys read from the pty are
+// queued for the start of the next slice.
+static void runRealtime(int fd, unsigned long runMs) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long ms = 0; ms < runMs; ms += PTY_SLICE_MS) {
+    char c;
+    while (read(fd, &c, 1) == 1) simPushKey(ms, c);
+    simRunUntilMs(ms + PTY_SLICE_MS);
+    simClearTraces();
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(ms + PTY_SLICE_MS));
+  }
+}
+
+// ===================================================
+//  MAIN
+// ===================================================
+int main(int argc, char **argv) {
+  const char *scenarioPath = nullptr;
+  const char *tracePath = nullptr;
+  bool echo = false;
+  bool pty = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+    else if (strcmp(argv[i], "--log") == 0) echo = true;
+    else if (strcmp(argv[i], "--pty") == 0) pty = true;
+    else scenarioPath = argv[i];
+  }
+  if (!scenarioPath) {
+    fprintf(stderr, "usage: %s <scenario> [--trace file.csv] [--log] [--pty]\n", argv[0]);
+    return 2;
+  }
+
+  Scenario sc;
+  if (!loadScenario(scenarioPath, sc)) return 2;
+
+  // Separate namespace so simulator runs never touch real config records
+  configBegin("sim");
+  if (!sc.warm) {
+    configErase(CALIB_KEY);
+    configErase(SERVO_KEY);
+    configErase(ADC_CAL_KEY);
+    configErase(FINGER_KEY);
+  }
+
+  simReset();
+  simSetI2cHz(sc.i2cHz);
+  gripPowerOn();
+  simSetLoopCostUs(sc.loopCostUs);
+  simSetAdcSource(emgSource, &sc.emg);
+  CurrentCtx currentCtx = { &sc.load, &sc.emg };
+  if (sc.load.objectAngle >= 0) simSetCurrentSource(currentSource, &currentCtx);
+  if (echo) simSetUartSink(echoUart, nullptr);
+  for (auto &k : sc.keys) simPushKey(k.first, k.second);
+
+  gripRestore();
+  // As setup() does once the outputs are attached
+  actBegin(sc.backend);
+  forceBegin(sc.load.objectAngle >= 0);
+  for (auto &d : sc.decim) telemSetDecim(d.first, d.second);
+  for (const Expect &e : sc.expects)
+    if (e.kind == EXPECT_RMS_PEAKS) simCaptureTelemetry(true);
+  if (sc.adcSweep && !sweepAdc(sc.emg.adc)) {
+    fprintf(stderr, "ADC sweep failed\n");
+    return 2;
+  }
+  int initialState = (int)handState;
+
+  if (pty) {
+    int fd = openPty();
+    if (fd < 0) return 2;
+    simSetUartSink(ptyUart, &fd);
+    printf("streaming %lu ms of %s on %s\n", sc.runMs, scenarioPath, ptsname(fd));
+    fflush(stdout);
+    runRealtime(fd, sc.runMs);
+    close(fd);
+    return 0;
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::stable_sort(sc.events.begin(), sc.events.end(),
+                   [](const std::pair<unsigned long, long> &a,
+                      const std::pair<unsigned long, long> &b) { return a.first < b.first; });
+  for (auto &ev : sc.events) {
+    simRunUntilMs(ev.first);
+    if (ev.second != SIM_REBOOT) { simSetLoopCostUs(ev.second); continue; }
+    // Power cycle: RAM state is lost, config survives; time runs on
+    gripPowerOn();
+    gripRestore();
+    actBegin(sc.backend);
+    forceBegin(sc.load.objectAngle >= 0);
+    halPrintf(">> Reboot (%s, angle %d)\n", warmBoot ? "warm" : "cold", servoAngle);
+  }
+  simRunUntilMs(sc.runMs);
+  double wallMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+
+  int failed = 0;
+  for (const Expect &e : sc.expects) {
+    std::string got;
+    if (!check(e, initialState, got)) {
+      failed++;
+      printf("FAIL %s:%d: expected %s at %lu ms, got %s\n",
+             scenarioPath, e.line,
+             e.kind == EXPECT_ANGLE ? std::to_string(e.value).c_str() : e.text.c_str(),
+             e.ms, got.c_str());
+    }
+  }
+
+  if (tracePath) {
+    FILE *f = fopen(tracePath, "w");
+    if (f) {
+      fprintf(f, "ms,channel,angle\n");
+      for (const SimServoEvent &e : simServoTrace())
+        fprintf(f, "%lu,%u,%d\n", e.ms, e.ch, e.angle);
+      fclose(f);
+    }
+  }
+
+  for (const SimLogLine &l : simLog())
+    if (l.text.rfind(">>", 0) == 0) printf("%8lu ms  %s\n", l.ms, l.text.c_str());
+
+  printf("%lu ms simulated in %.1f ms (%.0fx real time), %lu passes, %lu missed samples\n",
+         sc.runMs, wallMs, wallMs > 0 ? sc.runMs / wallMs : 0.0,
+         simLoopPasses(), simMissedSamples());
+  if (!simI2cTrace().empty()) {
+    const ActStats &as = actStats();
+    printf("i2c: %lu transactions, %lu bytes for %lu channel writes, longest flush %lu us\n",
+           (unsigned long)simI2cTrace().size(), (unsigned long)as.bytes,
+           (unsigned long)as.channelWrites, (unsigned long)as.maxFlushUs);
+  }
+  printf("%zu/%zu expectations passed\n", sc.expects.size() - failed, sc.expects.size());
+  return failed;
+}
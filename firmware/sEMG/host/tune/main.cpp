@@ -0,0 +1,453 @@
+// ===================================================
+//  sEMG GRIP — PARAMETER AUTO-TUNER
+//
+//  Searches threshold, CONFIRM_MS, RELEASE_MS,
+//  SERVO_STEP_MS and the filter constants against
+//  labelled sessions and prints the Pareto front of
+//  activation latency vs false triggers per hour.
+//
+//  The firmware pipeline is split at rmsValue: the
+//  DSP stage (processEMG, depends on hp/lp only) runs
+//  once per session and filter setting into a cached
+//  trace of the RMS and the signal-quality gate; every
+//  candidate sharing those filters replays only the
+//  decision and servo tasks over it, in chunks spread
+//  across the pool.
+//
+//  usage: tune <dir|file.ses>... [options]
+//    --strategy grid|halving  (default halving)
+//    --eta N            session growth per round  (3)
+//    --candidates N     random subset of the grid (all)
+//    --threshold A:B:S  --confirm A:B:S  --release A:B:S
+//    --step A:B:S       --hp A:B:S       --lp A:B:S
+//    --max-missed F     max missed-contraction fraction (0.05)
+//    --threads T  --seed X  --csv FILE
+// ===================================================
+#include <ConfigStore.h>
+#include <GripControl.h>
+#include <Scheduler.h>
+#include <SessionFile.h>
+#include <SignalQuality.h>
+#include <SimHal.h>
+#include <WorkPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#define BLOCK_SAMPLES   4096
+#define CANDIDATE_CHUNK 16
+#define MIN_FINALISTS   16
+
+// ===================================================
+//  SEARCH SPACE
+// ===================================================
+struct Range {
+  double lo, hi, step;
+  std::vector<double> values() const {
+    std::vector<double> v;
+    if (step <= 0 || hi <= lo) { v.push_back(lo); return v; }
+    for (int i = 0; lo + i * step <= hi + step * 1e-6; i++) v.push_back(lo + i * step);
+    return v;
+  }
+};
+
+static bool parseRange(const char *s, Range &r) {
+  int n = sscanf(s, "%lf:%lf:%lf", &r.lo, &r.hi, &r.step);
+  if (n == 1) { r.hi = r.lo; r.step = 0; }
+  return n == 1 || n == 3;
+}
+
+struct Candidate {
+  float      threshold;
+  GripParams params;
+  int        dsp;        // index into the distinct (hp, lp) pairs
+  bool       alive = true;
+};
+
+struct Score {
+  uint64_t falseAct = 0, hits = 0, labels = 0, samples = 0;
+  double   latencySumMs = 0;
+  bool     done = false;
+};
+
+struct Summary {
+  double latencyMs, falsePerHour, missed;
+};
+
+// ===================================================
+//  SESSIONS + TRACE CACHE
+// ===================================================
+struct Session {
+  std::string path;
+  uint64_t samples;
+  std::vector<SessionLabel> labels;
+};
+
+// What the sample task leaves for the decision and servo tasks
+struct Trace {
+  std::vector<float> rms;
+  std::vector<bool>  good;     // sqGood() after each sample
+  size_t size() const { return rms.size(); }
+};
+
+// DSP stage: the firmware's own processEMG() over the whole session
+static std::shared_ptr<const Trace> computeTrace(const Session &s, float hp, float lp) {
+  auto trace = std::make_shared<Trace>();
+  trace->rms.reserve(s.samples);
+  trace->good.reserve(s.samples);
+  SessionReader reader;
+  if (!reader.open(s.path.c_str())) return trace;
+
+  gripPowerOn();
+  gripParams.hpAlpha = hp;
+  gripParams.lpAlpha = lp;
+  uint16_t buf[BLOCK_SAMPLES];
+  while (size_t n = reader.read(buf, BLOCK_SAMPLES)) {
+    for (size_t i = 0; i < n; i++) {
+      processEMG(buf[i]);
+      trace->rms.push_back(rmsValue);
+      trace->good.push_back(sqGood());
+    }
+  }
+  return trace;
+}
+
+// Decision stage: the decision and servo tasks in virtual time, in the
+// same order as gripLoop(). Tick k+1 carries sample k.
+static Score replay(const Trace &trace, const Session &s, const Candidate &c) {
+  Score sc;
+  gripPowerOn();
+  gripParams = c.params;
+  simReset();
+  simMuteUart(true);
+  simTraceServos(false);
+  gripRestore();
+  threshold = c.threshold;
+
+  std::vector<bool> hit(s.labels.size(), false);
+  size_t labelIdx = 0;
+  int state = (int)handState;
+
+  for (size_t k = 0; k < trace.size(); k++) {
+    uint64_t ms = k + 1;
+    simSetNowUs((unsigned long)(ms * 1000));
+    rmsValue = trace.rms[k];
+    sqOk     = trace.good[k];
+    schedPass(GRIP_TASK_BIT(TASK_DECIDE) | GRIP_TASK_BIT(TASK_SERVO));
+
+    int now = (int)handState;
+    if (now != state && state == IDLE && now == CLOSING) {
+      while (labelIdx < s.labels.size() &&
+             s.labels[labelIdx].offset + 1 + c.params.releaseMs < ms) labelIdx++;
+      if (labelIdx < s.labels.size() && s.labels[labelIdx].onset + 1 <= ms) {
+        if (!hit[labelIdx]) {
+          hit[labelIdx] = true;
+          sc.hits++;
+          sc.latencySumMs += (double)(ms - (s.labels[labelIdx].onset + 1));
+        }
+      } else {
+        sc.falseAct++;
+      }
+    }
+    state = now;
+  }
+  sc.labels  = s.labels.size();
+  sc.samples = trace.size();
+  sc.done    = true;
+  return sc;
+}
+
+// ===================================================
+//  PARETO
+// ===================================================
+static Summary summarise(const std::vector<Score> &row, size_t sessions) {
+  uint64_t f = 0, h = 0, l = 0, n = 0;
+  double lat = 0;
+  for (size_t s = 0; s < sessions; s++) {
+    f += row[s].falseAct; h += row[s].hits; l += row[s].labels; n += row[s].samples;
+    lat += row[s].latencySumMs;
+  }
+  double hours = n / (3600.0 * SAMPLE_RATE_HZ);
+  Summary sm;
+  sm.latencyMs    = h ? lat / h : 1e9;
+  sm.falsePerHour = hours > 0 ? f / hours : 0;
+  sm.missed       = l ? 1.0 - (double)h / l : 0;
+  return sm;
+}
+
+static bool dominates(const Summary &a, const Summary &b) {
+  return a.latencyMs <= b.latencyMs && a.falsePerHour <= b.falsePerHour &&
+         (a.latencyMs < b.latencyMs || a.falsePerHour < b.falsePerHour);
+}
+
+// Non-dominated sorting layer of each index; infeasible ones go last
+static std::vector<int> paretoRanks(const std::vector<Summary> &s, const std::vector<int> &idx,
+                                    double maxMissed) {
+  std::vector<int> rank(idx.size(), -1);
+  size_t left = idx.size();
+  for (int layer = 0; left > 0; layer++) {
+    std::vector<size_t> now;
+    for (size_t i = 0; i < idx.size(); i++) {
+      if (rank[i] >= 0) continue;
+      bool feasible = s[idx[i]].missed <= maxMissed;
+      bool dominated = false;
+      for (size_t j = 0; j < idx.size() && !dominated; j++) {
+        if (j == i || rank[j] >= 0) continue;
+        bool otherFeasible = s[idx[j]].missed <= maxMissed;
+        if (feasible != otherFeasible) dominated = otherFeasible;
+        else dominated = dominates(s[idx[j]], s[idx[i]]);
+      }
+      if (!dominated) now.push_back(i);
+    }
+    for (size_t i : now) rank[i] = layer;
+    left -= now.size();
+  }
+  return rank;
+}
+
+// ===================================================
+//  CORPUS
+// ===================================================
+static bool endsWith(const std::string &s, const char *suffix) {
+  size_t n = strlen(suffix);
+  return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static void collect(const char *arg, std::vector<std::string> &files) {
+  struct stat st;
+  if (stat(arg, &st) != 0) { fprintf(stderr, "cannot open %s\n", arg); return; }
+  if (!S_ISDIR(st.st_mode)) { files.push_back(arg); return; }
+  DIR *d = opendir(arg);
+  if (!d) return;
+  while (dirent *e = readdir(d)) {
+    if (e->d_name[0] == '.') continue;
+    std::string p = std::string(arg) + "/" + e->d_name;
+    if (endsWith(p, ".ses")) files.push_back(p);
+    else if (stat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) collect(p.c_str(), files);
+  }
+  closedir(d);
+}
+
+// ===================================================
+//  MAIN
+// ===================================================
+int main(int argc, char **argv) {
+  Range thr  = { 0.030, 0.120, 0.005 };
+  Range conf = { 50, 400, 50 };
+  Range rel  = { 100, 600, 100 };
+  Range step = { SERVO_STEP_MS, SERVO_STEP_MS, 0 };
+  Range hp   = { HP_ALPHA, HP_ALPHA, 0 };
+  Range lp   = { 0.5, 0.9, 0.1 };
+  bool halving = true;
+  unsigned eta = 3, threads = 0;
+  size_t maxCandidates = 0;
+  uint64_t seed = 1;
+  double maxMissed = 0.05;
+  const char *csvPath = nullptr;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; i++) {
+    const char *a = argv[i];
+    bool more = i + 1 < argc, ok = true;
+    if      (!strcmp(a, "--strategy") && more)   halving = strcmp(argv[++i], "grid") != 0;
+    else if (!strcmp(a, "--eta") && more)        eta = std::max(2, atoi(argv[++i]));
+    else if (!strcmp(a, "--candidates") && more) maxCandidates = atol(argv[++i]);
+    else if (!strcmp(a, "--threshold") && more)  ok = parseRange(argv[++i], thr);
+    else if (!strcmp(a, "--confirm") && more)    ok = parseRange(argv[++i], conf);
+    else if (!strcmp(a, "--release") && more)    ok = parseRange(argv[++i], rel);
+    else if (!strcmp(a, "--step") && more)       ok = parseRange(argv[++i], step);
+    else if (!strcmp(a, "--hp") && more)         ok = parseRange(argv[++i], hp);
+    else if (!strcmp(a, "--lp") && more)         ok = parseRange(argv[++i], lp);
+    else if (!strcmp(a, "--max-missed") && more) maxMissed = atof(argv[++i]);
+    else if (!strcmp(a, "--threads") && more)    threads = atoi(argv[++i]);
+    else if (!strcmp(a, "--seed") && more)       seed = strtoull(argv[++i], nullptr, 0);
+    else if (!strcmp(a, "--csv") && more)        csvPath = argv[++i];
+    else if (a[0] == '-') ok = false;
+    else collect(a, files);
+    if (!ok) { fprintf(stderr, "bad option %s (see header of host/tune/main.cpp)\n", a); return 2; }
+  }
+
+  // Only labelled sessions can score latency and false triggers
+  std::sort(files.begin(), files.end());
+  std::vector<Session> sessions;
+  for (const std::string &f : files) {
+    SessionReader r;
+    if (!r.open(f.c_str()) || r.header().sampleRateHz != SAMPLE_RATE_HZ) continue;
+    Session s;
+    s.path = f;
+    s.samples = r.header().samples;
+    s.labels.resize(s.samples / SAMPLE_RATE_HZ + 16);
+    long n = sessionReadLabels(f.c_str(), s.labels.data(), s.labels.size());
+    if (n < 0) continue;
+    if (n > (long)s.labels.size()) {
+      fprintf(stderr, "%s: %ld labels, scoring the first %zu\n",
+              f.c_str(), n, s.labels.size());
+      n = (long)s.labels.size();
+    }
+    s.labels.resize(n);
+    sessions.push_back(std::move(s));
+  }
+  if (sessions.empty()) {
+    fprintf(stderr, "usage: tune <dir|file.ses>... [options]; no labelled sessions found\n");
+    return 2;
+  }
+
+  // Candidate grid; the firmware defaults are always included
+  std::vector<std::pair<float, float>> dsps;
+  auto dspIndex = [&dsps](float h, float l) {
+    for (size_t i = 0; i < dsps.size(); i++)
+      if (dsps[i].first == h && dsps[i].second == l) return (int)i;
+    dsps.push_back({ h, l });
+    return (int)dsps.size() - 1;
+  };
+  std::vector<Candidate> cands;
+  for (double h : hp.values()) for (double l : lp.values())
+  for (double t : thr.values()) for (double c : conf.values())
+  for (double r : rel.values()) for (double s : step.values()) {
+    Candidate cd;
+    cd.threshold = (float)t;
+    cd.params = { (float)h, (float)l, (unsigned long)c, (unsigned long)r, (unsigned long)s };
+    cd.dsp = dspIndex((float)h, (float)l);
+    cands.push_back(cd);
+  }
+  if (maxCandidates && cands.size() > maxCandidates) {
+    std::mt19937_64 rng(seed);
+    std::shuffle(cands.begin(), cands.end(), rng);
+    cands.resize(maxCandidates);
+  }
+  Candidate def;
+  def.threshold = DEFAULT_THRESHOLD;
+  def.params = GRIP_PARAMS_DEFAULT;
+  def.dsp = dspIndex(HP_ALPHA, LP_ALPHA);
+  cands.push_back(def);
+  const size_t defIdx = cands.size() - 1;
+
+  configBegin("");
+  std::atomic<uint64_t> dspPasses{0}, replays{0};
+  std::vector<std::vector<Score>> scores(cands.size(), std::vector<Score>(sessions.size()));
+  WorkPool pool(threads);
+  auto t0 = std::chrono::steady_clock::now();
+
+  // Successive halving grows the session set by eta per round and cuts
+  // the field geometrically down to MIN_FINALISTS; grid is one round
+  // over every session
+  int rounds = 0;
+  if (halving && cands.size() > MIN_FINALISTS)
+    for (size_t n = 1; n < sessions.size(); n *= eta) rounds++;
+  double keepFactor = rounds ? pow((double)MIN_FINALISTS / cands.size(), 1.0 / rounds) : 1.0;
+
+  std::vector<Summary> sums(cands.size());
+  for (int r = 0; r <= rounds; r++) {
+    size_t used = sessions.size();
+    for (int k = r; k < rounds; k++) used = (used + eta - 1) / eta;
+    used = std::max<size_t>(used, 1);
+
+    // One task per (session, filter setting): compute the trace once,
+    // then fan candidate chunks out to the pool (they share it)
+    for (size_t s = 0; s < used; s++) {
+      for (size_t d = 0; d < dsps.size(); d++) {
+        std::vector<size_t> todo;
+        for (size_t c = 0; c < cands.size(); c++)
+          if (cands[c].alive && cands[c].dsp == (int)d && !scores[c][s].done) todo.push_back(c);
+        if (todo.empty()) continue;
+
+        pool.submit([&, s, d, todo](unsigned) {
+          std::shared_ptr<const Trace> trace =
+            computeTrace(sessions[s], dsps[d].first, dsps[d].second);
+          dspPasses++;
+          replays += todo.size();
+          for (size_t i = 0; i < todo.size(); i += CANDIDATE_CHUNK) {
+            std::vector<size_t> chunk(todo.begin() + i,
+                                      todo.begin() + std::min(todo.size(), i + CANDIDATE_CHUNK));
+            pool.submit([&, s, trace, chunk](unsigned) {
+              for (size_t c : chunk) scores[c][s] = replay(*trace, sessions[s], cands[c]);
+            });
+          }
+        });
+      }
+    }
+    pool.wait();
+
+    std::vector<int> alive;
+    for (size_t c = 0; c < cands.size(); c++) {
+      if (!cands[c].alive) continue;
+      sums[c] = summarise(scores[c], used);
+      alive.push_back((int)c);
+    }
+    printf("round %d: %zu candidates on %zu/%zu sessions\n", r, alive.size(), used, sessions.size());
+    if (r == rounds) break;
+
+    // Keep the best by Pareto layer, then by a normalised sum
+    std::vector<int> rank = paretoRanks(sums, alive, maxMissed);
+    std::vector<size_t> order(alive.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      if (rank[a] != rank[b]) return rank[a] < rank[b];
+      const Summary &x = sums[alive[a]], &y = sums[alive[b]];
+      return x.latencyMs / 100.0 + x.falsePerHour < y.latencyMs / 100.0 + y.falsePerHour;
+    });
+    size_t keep = std::max<size_t>(MIN_FINALISTS, (size_t)ceil(alive.size() * keepFactor));
+    for (size_t i = keep; i < order.size(); i++)
+      if ((size_t)alive[order[i]] != defIdx) cands[alive[order[i]]].alive = false;
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  // Final front among candidates scored on every session
+  std::vector<int> finalists;
+  for (size_t c = 0; c < cands.size(); c++)
+    if (cands[c].alive) finalists.push_back((int)c);
+  std::vector<int> rank = paretoRanks(sums, finalists, maxMissed);
+  std::vector<int> front;
+  for (size_t i = 0; i < finalists.size(); i++)
+    if (rank[i] == 0 && sums[finalists[i]].missed <= maxMissed) front.push_back(finalists[i]);
+  std::sort(front.begin(), front.end(),
+            [&](int a, int b) { return sums[a].latencyMs < sums[b].latencyMs; });
+
+  auto row = [&](const char *tag, int c) {
+    const Candidate &cd = cands[c];
+    const Summary &sm = sums[c];
+    printf("%-8s %7.3f %6lu %6lu %5lu %7.4f %5.2f %9.0f %8.2f %7.1f%%\n", tag,
+           cd.threshold, cd.params.confirmMs, cd.params.releaseMs, cd.params.servoStepMs,
+           cd.params.hpAlpha, cd.params.lpAlpha, sm.latencyMs, sm.falsePerHour, 100 * sm.missed);
+  };
+  printf("\nPareto front (latency vs false triggers, missed <= %.0f%%)\n", 100 * maxMissed);
+  printf("%-8s %7s %6s %6s %5s %7s %5s %9s %8s %8s\n", "", "thresh", "conf", "rel", "step",
+         "hp", "lp", "lat_ms", "false/h", "missed");
+  for (int c : front) row("front", c);
+  row("default", (int)defIdx);
+
+  printf("\n%zu candidates, %zu filter settings, %zu sessions, %.2f s wall, %u threads, "
+         "%llu DSP passes shared by %llu replays, %llu steals\n",
+         cands.size(), dsps.size(), sessions.size(), wall, pool.size(),
+         (unsigned long long)dspPasses.load(), (unsigned long long)replays.load(),
+         (unsigned long long)pool.steals());
+
+  if (csvPath) {
+    FILE *f = fopen(csvPath, "w");
+    if (f) {
+      fprintf(f, "threshold,confirm_ms,release_ms,step_ms,hp,lp,latency_ms,false_per_hour,missed,front\n");
+      for (int c : finalists) {
+        const Candidate &cd = cands[c];
+        bool onFront = std::find(front.begin(), front.end(), c) != front.end();
+        fprintf(f, "%.4f,%lu,%lu,%lu,%.4f,%.3f,%.1f,%.3f,%.4f,%d\n", cd.threshold,
+                cd.params.confirmMs, cd.params.releaseMs, cd.params.servoStepMs,
+                cd.params.hpAlpha, cd.params.lpAlpha, sums[c].latencyMs,
+                sums[c].falsePerHour, sums[c].missed, onFront);
+      }
+      fclose(f);
+    }
+  }
+  return 0;
+}
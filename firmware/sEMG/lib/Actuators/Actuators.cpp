@@ -0,0 +1,107 @@
+#include "Actuators.h"
+
+#include <Hal.h>
+#include <string.h>
+
+static const char *BACKEND_NAMES[] = { "direct", "pca9685" };
+
+static GRIP_STATE ActStats   stats;
+static GRIP_STATE ActBackend backend = ACT_DIRECT;
+static GRIP_STATE uint32_t   dirty = 0;
+
+static inline int16_t *angles() { return arenaStore<ActStore, ARENA_ACTUATORS>().angles; }
+
+void actReset() {
+  memset(&stats, 0, sizeof(stats));
+  backend = ACT_DIRECT;
+  dirty   = 0;
+  for (int ch = 0; ch < NUM_ACTUATORS; ch++) angles()[ch] = -1;
+  actSet(ACT_WRIST, ACT_REST_ANGLE);
+  actSet(ACT_THUMB_ROT, ACT_REST_ANGLE);
+}
+
+bool actBegin(ActBackend b) {
+  backend = b;
+  bool ok = b != ACT_PCA9685 || pca9685Begin(PCA9685_ADDR);
+  if (!ok) stats.errors++;
+  // Everything staged so far goes out now
+  for (int ch = 0; ch < NUM_ACTUATORS; ch++)
+    if (angles()[ch] >= 0) dirty |= 1UL << ch;
+  actFlush();
+  return ok;
+}
+
+void actSet(int ch, int angle) {
+  if (ch < 0 || ch >= NUM_ACTUATORS) return;
+  if (angle < 0) angle = 0;
+  if (angle > ACT_ANGLE_MAX) angle = ACT_ANGLE_MAX;
+  int16_t *a = angles();
+  if (a[ch] == angle) return;
+  a[ch] = (int16_t)angle;
+  dirty |= 1UL << ch;
+}
+
+// ===================================================
+//  FLUSH
+// ===================================================
+static void flushDirect() {
+  for (int ch = 0; ch < NUM_ACTUATORS; ch++) {
+    if (!(dirty >> ch & 1)) continue;
+    halServoWrite(ch, angles()[ch]);
+    stats.channelWrites++;
+  }
+  dirty = 0;
+}
+
+// One burst from the lowest to the highest changed channel;
+// unchanged ones in between are rewritten with the same value
+static void flushPca9685() {
+  int lo = 0, hi = NUM_ACTUATORS - 1;
+  while (!(dirty >> lo & 1)) lo++;
+  while (!(dirty >> hi & 1)) hi--;
+  uint16_t pulse[NUM_ACTUATORS];
+  for (int ch = lo; ch <= hi; ch++) pulse[ch] = actPulseUs(angles()[ch]);
+
+  size_t sent = pca9685Write(PCA9685_ADDR, pulse, lo, hi);
+  stats.transactions++;
+  if (!sent) { stats.errors++; return; }
+  stats.bytes += sent;
+  stats.channelWrites += hi - lo + 1;
+  dirty = 0;
+}
+
+void actFlush() {
+  if (!dirty) return;
+  unsigned long start = halMicros();
+  if (backend == ACT_PCA9685) flushPca9685();
+  else                        flushDirect();
+  unsigned long took = halMicros() - start;
+  stats.flushes++;
+  if (took > stats.maxFlushUs) stats.maxFlushUs = took;
+}
+
+// ===================================================
+//  QUERIES
+// ===================================================
+int        actAngle(int ch) { return ch >= 0 && ch < NUM_ACTUATORS ? angles()[ch] : -1; }
+ActBackend actBackend()     { return backend; }
+
+uint16_t actPulseUs(int angle) {
+  return (uint16_t)(ACT_PULSE_MIN_US + angle * (ACT_PULSE_MAX_US - ACT_PULSE_MIN_US) / ACT_ANGLE_MAX);
+}
+
+int actPulseAngle(uint32_t us) {
+  const int span = ACT_PULSE_MAX_US - ACT_PULSE_MIN_US;
+  int d = ((int)us - ACT_PULSE_MIN_US) * ACT_ANGLE_MAX;
+  return d >= 0 ? (d + span / 2) / span : -((-d + span / 2) / span);
+}
+
+const ActStats &actStats() { return stats; }
+
+void actPrint() {
+  halPrintf("ACTUATORS %s x%d flushes=%lu writes=%lu i2c=%lu bytes=%lu errors=%lu max=%lu us\n",
+            BACKEND_NAMES[backend], NUM_ACTUATORS, (unsigned long)stats.flushes,
+            (unsigned long)stats.channelWrites, (unsigned long)stats.transactions,
+            (unsigned long)stats.bytes, (unsigned long)stats.errors,
+            (unsigned long)stats.maxFlushUs);
+}
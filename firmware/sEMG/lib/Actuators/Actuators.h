@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+#include <Pca9685.h>
+
+// ===================================================
+//  ACTUATOR OUTPUT
+//
+//  NUM_ACTUATORS servo channels: the fingers, then
+//  the wrist and thumb rotation axes. Control code
+//  stages angles with actSet() and sends them with one
+//  actFlush() per update; only channels whose angle
+//  changed go out.
+//
+//  Backends (ACT_BACKEND, a build flag):
+//  - ACT_DIRECT: halServoWrite() per changed channel,
+//    one LEDC output per servo on the ESP32
+//  - ACT_PCA9685: one I2C burst per flush covering
+//    the changed channels, through halI2cWrite(). It
+//    uses no LEDC timers; a NACKed burst stays
+//    pending and goes out with the next flush
+//
+//  The extra axes hold ACT_REST_ANGLE until something
+//  drives them. 'v' prints the counters.
+// ===================================================
+#define ACT_WRIST          NUM_FINGERS
+#define ACT_THUMB_ROT      (NUM_FINGERS + 1)
+#define ACT_REST_ANGLE     90
+#define ACT_ANGLE_MAX      180
+#define ACT_PULSE_MIN_US   500          // 0 deg, as ESP32Servo attach()
+#define ACT_PULSE_MAX_US   2400         // ACT_ANGLE_MAX
+#define ACT_I2C_HZ         400000
+
+enum ActBackend { ACT_DIRECT, ACT_PCA9685 };
+
+#ifndef ACT_BACKEND
+#define ACT_BACKEND ACT_DIRECT
+#endif
+
+static_assert(NUM_ACTUATORS <= PCA9685_CHANNELS, "more actuators than PCA9685 outputs");
+static_assert(NUM_ACTUATORS <= 32, "dirty mask is 32 bits");
+
+// Staged angles, -1 unwritten (lib/Arena, ARENA_ACTUATORS)
+struct ActStore {
+  int16_t angles[NUM_ACTUATORS];
+};
+
+struct ActStats {
+  uint32_t flushes;          // flushes with changes to send
+  uint32_t channelWrites;
+  uint32_t transactions;     // I2C bursts
+  uint32_t bytes;            // I2C payload
+  uint32_t errors;           // NACKed bursts
+  uint32_t maxFlushUs;
+};
+
+// Power-on: direct backend, every channel unwritten
+void actReset();
+// Select the backend and send every staged channel
+bool actBegin(ActBackend b);
+void actSet(int ch, int angle);
+void actFlush();
+
+int        actAngle(int ch);
+ActBackend actBackend();
+
+// Servo angle <-> pulse width
+uint16_t actPulseUs(int angle);
+int      actPulseAngle(uint32_t us);
+
+const ActStats &actStats();
+void actPrint();
@@ -0,0 +1,210 @@
+#include "AdcCal.h"
+
+#include <ConfigStore.h>
+#include <Hal.h>
+
+static GRIP_STATE AdcCalRecord cal;
+
+struct SweepState {
+  bool    active;
+  int     points;
+  int     typedMv;       // -1: nothing typed yet
+  int     takingMv;      // -1: not taking a point
+  int     skip, count;
+  int32_t sum;
+};
+
+static GRIP_STATE SweepState sweep;
+
+static inline float *adcVolts() { return arenaStore<AdcCalStore, ARENA_ADC_CAL>().volts; }
+
+static inline int knotCode(int k) {
+  int c = k * ADC_CAL_STEP;
+  return c < ADC_CAL_CODES ? c : ADC_CAL_CODES - 1;
+}
+
+// ===================================================
+//  EFUSE BACKEND
+// ===================================================
+#ifdef ARDUINO
+#include <esp_adc_cal.h>
+
+bool adcCalFromEfuse() {
+  esp_adc_cal_characteristics_t chars;
+  esp_adc_cal_value_t type = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11,
+                                                      ADC_WIDTH_BIT_12, 1100, &chars);
+  // No two-point or Vref fuse burnt: nothing better than ideal
+  if (type == ESP_ADC_CAL_VAL_DEFAULT_VREF) return false;
+
+  uint16_t dmv[ADC_CAL_KNOTS];
+  for (int k = 0; k < ADC_CAL_KNOTS; k++)
+    dmv[k] = (uint16_t)(esp_adc_cal_raw_to_voltage(knotCode(k), &chars) * 10);
+  return adcCalFromKnots(dmv, ADC_CAL_EFUSE);
+}
+
+#else
+
+bool adcCalFromEfuse() { return false; }
+#endif
+
+// ===================================================
+//  TABLE
+// ===================================================
+void adcCalIdeal() {
+  sweep.active = false;
+  cal.source = ADC_CAL_IDEAL;
+  float *volts = adcVolts();
+  for (int c = 0; c < ADC_CAL_CODES; c++)
+    volts[c] = (c / ADC_MAX) * VREF - MIDPOINT;
+}
+
+bool adcCalFromKnots(const uint16_t *dmv, uint8_t source) {
+  for (int k = 1; k < ADC_CAL_KNOTS; k++)
+    if (dmv[k] <= dmv[k - 1]) return false;
+
+  cal.source = source;
+  for (int k = 0; k < ADC_CAL_KNOTS; k++) cal.dmv[k] = dmv[k];
+
+  float *volts = adcVolts();
+  for (int k = 0; k < ADC_CAL_KNOTS - 1; k++) {
+    int   c0 = knotCode(k), c1 = knotCode(k + 1);
+    float v0 = dmv[k] * 1e-4f, v1 = dmv[k + 1] * 1e-4f;
+    float slope = (v1 - v0) / (c1 - c0);
+    for (int c = c0; c <= c1; c++)
+      volts[c] = v0 + (c - c0) * slope - MIDPOINT;
+  }
+  return true;
+}
+
+// Next point after `i` whose code rises above codes[i]: repeats are
+// the flat, saturated ends of the transfer curve
+static int nextRising(const int *codes, int n, int i) {
+  int j = i + 1;
+  while (j < n && codes[j] <= codes[i]) j++;
+  return j;
+}
+
+bool adcCalFromSweep(const int *codes, const float *volts, int n) {
+  if (n < 2) return false;
+  int b = nextRising(codes, n, 0);
+  if (b >= n) return false;
+  int a = b - 1;               // last point of a flat start
+
+  uint16_t dmv[ADC_CAL_KNOTS];
+  for (int k = 0; k < ADC_CAL_KNOTS; k++) {
+    int c = knotCode(k);
+    int next;
+    while (codes[b] < c && (next = nextRising(codes, n, b)) < n) { a = b; b = next; }
+    float v = volts[a] + (c - codes[a]) * (volts[b] - volts[a]) / (codes[b] - codes[a]);
+    float d = v * 1e4f;
+    dmv[k] = (uint16_t)(d < 0 ? 0 : d > 65535.0f ? 65535 : d + 0.5f);
+  }
+  return adcCalFromKnots(dmv, ADC_CAL_SWEEP);
+}
+
+// ===================================================
+//  BENCH SWEEP ON THE DEVICE
+// ===================================================
+void adcSweepStart() {
+  if (handState != IDLE) {
+    halPrintln("ADC SWEEP needs the hand open and idle");
+    return;
+  }
+  sweep.active   = true;
+  sweep.points   = 0;
+  sweep.typedMv  = -1;
+  sweep.takingMv = -1;
+  halPrintln("ADC SWEEP: step the input from 0 V up, send its mV + Enter, b to fit and save");
+}
+
+bool adcSweepActive() { return sweep.active; }
+
+static void takePoint(int mv) {
+  AdcCalStore &st = arenaStore<AdcCalStore, ARENA_ADC_CAL>();
+  if (sweep.takingMv >= 0) {
+    halPrintln("ADC SWEEP busy, point ignored");
+    return;
+  }
+  if (sweep.points == ADC_SWEEP_POINTS) {
+    halPrintln("ADC SWEEP full, send b");
+    return;
+  }
+  if (sweep.points > 0 && mv * 1e-3f <= st.sweepVolts[sweep.points - 1]) {
+    halPrintf("ADC SWEEP %d mV not above the last point, ignored\n", mv);
+    return;
+  }
+  sweep.takingMv = mv;
+  sweep.skip     = ADC_SWEEP_SETTLE;
+  sweep.count    = 0;
+  sweep.sum      = 0;
+}
+
+static void finishSweep() {
+  AdcCalStore &st = arenaStore<AdcCalStore, ARENA_ADC_CAL>();
+  sweep.active = false;
+  if (!adcCalFromSweep(st.sweepCode, st.sweepVolts, sweep.points)) {
+    halPrintf("ADC SWEEP failed (%d points), table unchanged\n", sweep.points);
+    return;
+  }
+  halPrintf("ADC SWEEP %s (%d points)\n", adcCalSave() ? "saved" : "applied (not saved)",
+            sweep.points);
+}
+
+bool adcSweepCommand(char cmd) {
+  if (!sweep.active) return false;
+  if (cmd >= '0' && cmd <= '9') {
+    int mv = (sweep.typedMv < 0 ? 0 : sweep.typedMv) * 10 + (cmd - '0');
+    sweep.typedMv = mv > 99999 ? 99999 : mv;
+  } else if (cmd == '\n' || cmd == '\r') {
+    if (sweep.typedMv >= 0) takePoint(sweep.typedMv);
+    sweep.typedMv = -1;
+  } else if (cmd == 'b') {
+    finishSweep();
+  }
+  return true;
+}
+
+void adcSweepSample(int adc) {
+  if (!sweep.active || sweep.takingMv < 0) return;
+  if (sweep.skip > 0) { sweep.skip--; return; }
+  sweep.sum += adc;
+  if (++sweep.count < ADC_SWEEP_AVG) return;
+
+  AdcCalStore &st = arenaStore<AdcCalStore, ARENA_ADC_CAL>();
+  int code = (sweep.sum + ADC_SWEEP_AVG / 2) / ADC_SWEEP_AVG;
+  st.sweepCode[sweep.points]  = code;
+  st.sweepVolts[sweep.points] = sweep.takingMv * 1e-3f;
+  sweep.points++;
+  halPrintf("ADC SWEEP %d: %d mV -> code %d\n", sweep.points, sweep.takingMv, code);
+  sweep.takingMv = -1;
+}
+
+// ===================================================
+//  PERSISTENCE
+// ===================================================
+bool adcCalSave() {
+  if (cal.source == ADC_CAL_IDEAL) return false;
+  return configSave(ADC_CAL_KEY, ADC_CAL_VERSION, &cal, sizeof(cal));
+}
+
+void adcCalRestore() {
+  AdcCalRecord rec;
+  if (configLoad(ADC_CAL_KEY, ADC_CAL_VERSION, &rec, sizeof(rec)) &&
+      adcCalFromKnots(rec.dmv, rec.source))
+    return;
+  if (adcCalFromEfuse()) {
+    adcCalSave();
+    return;
+  }
+  adcCalIdeal();
+}
+
+uint8_t adcCalSource() { return cal.source; }
+
+void adcCalPrint() {
+  static const char *NAMES[] = { "ideal", "efuse", "sweep" };
+  halPrintf("ADCCAL src=%s", NAMES[cal.source < 3 ? cal.source : 0]);
+  for (int k = 0; k < ADC_CAL_KNOTS; k += 8)
+    halPrintf(" %d:%.4f", knotCode(k), adcVolts()[knotCode(k)] + MIDPOINT);
+  halPrintf("\n");
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+
+// ===================================================
+//  ADC LINEARIZATION
+//
+//  The ESP32 ADC at 11 dB is bowed near both rails and
+//  its gain and offset differ from chip to chip.
+//  Rather than correct each sample with polynomial
+//  math, every ADC code is mapped once to its
+//  calibrated voltage, so that processEMG() only does
+//  a single table lookup per sample:
+//
+//  - the characterization is ADC_CAL_KNOTS voltages,
+//    one every ADC_CAL_STEP codes. It is stored in
+//    config; the table is rebuilt from it at boot by
+//    linear interpolation
+//  - knots come from the chip's eFuse calibration
+//    (target, first boot), or from a one-time bench
+//    sweep of known input voltages, which overrides
+//    eFuse
+//  - with no characterization the table is the ideal
+//    straight line processEMG() used before
+//
+//  Bench sweep on the device ('b', hand open): the
+//  bench steps a known voltage onto the EMG input,
+//  0 V upwards, and after each step sends that
+//  voltage in mV and a newline. The firmware averages
+//  ADC_SWEEP_AVG samples into one point, skipping
+//  ADC_SWEEP_SETTLE first. 'b' again fits the points
+//  and saves them. Grip control is suspended for the
+//  whole sweep; every key goes to the sweep.
+//
+//  Thresholds are then in true volts and carry over
+//  between boards.
+// ===================================================
+#define ADC_CAL_CODES    4096
+#define ADC_CAL_STEP     128
+#define ADC_CAL_KNOTS    (ADC_CAL_CODES / ADC_CAL_STEP + 1)   // last knot at code 4095
+#define ADC_CAL_KEY      "adccal"
+#define ADC_CAL_VERSION  1
+
+#define ADC_SWEEP_POINTS  96
+#define ADC_SWEEP_SETTLE  8      // samples after a step
+#define ADC_SWEEP_AVG     64     // samples per point
+
+enum AdcCalSource { ADC_CAL_IDEAL, ADC_CAL_EFUSE, ADC_CAL_SWEEP };
+
+struct AdcCalRecord {
+  uint8_t  source;                 // AdcCalSource
+  uint8_t  reserved;
+  uint16_t dmv[ADC_CAL_KNOTS];     // knot voltage, 0.1 mV units
+};
+
+// Code -> volts relative to MIDPOINT, and the points of a bench
+// sweep in progress (lib/Arena, ARENA_ADC_CAL)
+struct AdcCalStore {
+  float volts[ADC_CAL_CODES];
+  int   sweepCode[ADC_SWEEP_POINTS];
+  float sweepVolts[ADC_SWEEP_POINTS];
+};
+
+inline float adcToVolts(int adc) {
+  return arenaStore<AdcCalStore, ARENA_ADC_CAL>().volts[adc & (ADC_CAL_CODES - 1)];
+}
+
+// Ideal straight line (power-on)
+void adcCalIdeal();
+// Stored characterization, else eFuse (target, stored for next
+// boot), else ideal
+void adcCalRestore();
+// Build the table from knots; false (table unchanged) if they are
+// not increasing
+bool adcCalFromKnots(const uint16_t *dmv, uint8_t source);
+// Bench sweep: (code, volts) pairs in increasing input order. Points
+// past saturation are dropped; the ends are extrapolated.
+bool adcCalFromSweep(const int *codes, const float *volts, int n);
+// Target: characterize from eFuse; false on the host
+bool adcCalFromEfuse();
+bool adcCalSave();
+uint8_t adcCalSource();
+// Bench sweep on the device ('b')
+void adcSweepStart();
+bool adcSweepActive();
+// True if the sweep took the key
+bool adcSweepCommand(char cmd);
+// Every sample; only counts while a point is being taken
+void adcSweepSample(int adc);
+// Source and every eighth knot on the UART ('a' command)
+void adcCalPrint();
@@ -0,0 +1,135 @@
+#include "Arena.h"
+
+#include <Actuators.h>
+#include <AdcCal.h>
+#include <FlightRecorder.h>
+#include <Hal.h>
+#include <Pipeline.h>
+#include <Scheduler.h>
+#include <SignalQuality.h>
+#include <Teleplot.h>
+
+#include <new>
+
+GRIP_STATE GripArena gripArena;
+
+// Order of ArenaPart. arenaStore() checks each budget where the
+// store is used; these checks cover a store nobody touches yet.
+const ArenaPartInfo arenaParts[ARENA_PARTS] = {
+  { "dsp",       sizeof(DspStore),    ARENA_DSP_BUDGET       },
+  { "adc_cal",   sizeof(AdcCalStore), ARENA_ADC_CAL_BUDGET   },
+  { "quality",   sizeof(SqAcc),       ARENA_QUALITY_BUDGET   },
+  { "actuators", sizeof(ActStore),    ARENA_ACTUATORS_BUDGET },
+  { "sched",     sizeof(SchedStore),  ARENA_SCHED_BUDGET     },
+  { "telemetry", sizeof(TelemStore),  ARENA_TELEMETRY_BUDGET },
+  { "recorder",  sizeof(RecStore),    ARENA_RECORDER_BUDGET  },
+};
+
+static_assert(sizeof(DspStore)    <= ARENA_DSP_BUDGET,       "DspStore over budget");
+static_assert(sizeof(AdcCalStore) <= ARENA_ADC_CAL_BUDGET,   "AdcCalStore over budget");
+static_assert(sizeof(SqAcc)       <= ARENA_QUALITY_BUDGET,   "SqAcc over budget");
+static_assert(sizeof(ActStore)    <= ARENA_ACTUATORS_BUDGET, "ActStore over budget");
+static_assert(sizeof(SchedStore)  <= ARENA_SCHED_BUDGET,     "SchedStore over budget");
+static_assert(sizeof(TelemStore)  <= ARENA_TELEMETRY_BUDGET, "TelemStore over budget");
+static_assert(sizeof(RecStore)    <= ARENA_RECORDER_BUDGET,  "RecStore over budget");
+
+template <typename T, ArenaPart P>
+static void construct() {
+  static_assert(std::is_trivially_destructible<T>::value, "arena stores are never destroyed");
+  new (gripArena.bytes + arenaOffset(P)) T();
+}
+
+void arenaInit() {
+  construct<DspStore,    ARENA_DSP>();
+  construct<AdcCalStore, ARENA_ADC_CAL>();
+  construct<SqAcc,       ARENA_QUALITY>();
+  construct<ActStore,    ARENA_ACTUATORS>();
+  construct<SchedStore,  ARENA_SCHED>();
+  construct<TelemStore,  ARENA_TELEMETRY>();
+  construct<RecStore,    ARENA_RECORDER>();
+}
+
+// ===================================================
+//  HEAP GUARD — linked in with -Wl,--wrap=malloc etc.
+//  The wrappers live in IRAM: the IDF may allocate
+//  while the flash cache is off.
+// ===================================================
+#ifdef ARDUINO
+#include <esp_attr.h>
+
+static volatile bool     sealed     = false;
+static volatile uint32_t lateAllocs = 0;
+static volatile uint32_t lateBytes  = 0;
+
+static inline void IRAM_ATTR countAlloc(size_t n) {
+  if (!sealed) return;
+  __atomic_fetch_add(&lateAllocs, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&lateBytes, (uint32_t)n, __ATOMIC_RELAXED);
+}
+
+extern "C" {
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t count, size_t n);
+void *__real_realloc(void *p, size_t n);
+
+void *IRAM_ATTR __wrap_malloc(size_t n) {
+  countAlloc(n);
+  return __real_malloc(n);
+}
+
+void *IRAM_ATTR __wrap_calloc(size_t count, size_t n) {
+  countAlloc(count * n);
+  return __real_calloc(count, n);
+}
+
+void *IRAM_ATTR __wrap_realloc(void *p, size_t n) {
+  countAlloc(n);
+  return __real_realloc(p, n);
+}
+}
+
+#else
+
+static GRIP_STATE bool sealed     = false;
+static const uint32_t  lateAllocs = 0;
+static const uint32_t  lateBytes  = 0;
+#endif
+
+static GRIP_STATE uint32_t reported = 0;
+
+void arenaSeal() {
+  sealed   = true;
+  reported = 0;
+}
+
+void arenaCheckHeap() {
+  uint32_t n = lateAllocs;
+  if (!n || reported) return;
+  reported = n;
+  halPrintf(">> Heap: %lu allocation(s) after setup (%lu bytes)\n",
+            (unsigned long)n, (unsigned long)lateBytes);
+}
+
+HeapStats arenaHeapStats() {
+  HeapStats h = { sealed, lateAllocs, lateBytes };
+  return h;
+}
+
+// ===================================================
+//  REPORT
+// ===================================================
+void arenaPrint() {
+  uint32_t used = 0;
+  for (int i = 0; i < ARENA_PARTS; i++) used += arenaParts[i].used;
+  halPrintf("ARENA %lu of %lu bytes used, max %lu\n", (unsigned long)used,
+            (unsigned long)ARENA_BYTES, (unsigned long)ARENA_DRAM_MAX);
+  for (int i = 0; i < ARENA_PARTS; i++)
+    halPrintf("ARENA %-10s %6lu / %6lu\n", arenaParts[i].name,
+              (unsigned long)arenaParts[i].used, (unsigned long)arenaParts[i].budget);
+#ifdef ARDUINO
+  halPrintf("HEAP after setup: %lu allocs, %lu bytes%s\n", (unsigned long)lateAllocs,
+            (unsigned long)lateBytes, sealed ? "" : " (not sealed)");
+#else
+  halPrintf("HEAP after setup: not counted on host\n");
+#endif
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+#include <GripControl.h>
+
+// ===================================================
+//  STATIC MEMORY ARENA
+//
+//  The buffers of the signal path and everything fed
+//  from it live in one statically sized block,
+//  gripArena, cut into fixed parts. Each part has a
+//  byte budget for this build configuration (override
+//  one with -DARENA_<PART>_BUDGET=...):
+//
+//  - a store that outgrows its budget, or an arena
+//    that outgrows ARENA_DRAM_MAX, fails the build
+//  - offsets are compile-time constants, so a store
+//    costs the same to reach as a plain global
+//  - 'h' prints used bytes per part; after a firmware
+//    build scripts/ram_report.py prints the same table
+//    from the ELF, with DRAM/IRAM per library
+//
+//  Nothing after setup() allocates. The firmware links
+//  malloc/calloc/realloc (and so operator new) through
+//  counting wrappers (-Wl,--wrap, platformio.ini);
+//  arenaSeal() at the end of setup() arms them and the
+//  usage task reports the first late allocation.
+//  ESP-IDF code calling heap_caps_malloc() directly is
+//  not seen. Host tools do not count.
+//
+//  The arena holds buffers. Scalar control state and
+//  counters (GripForce, Gesture, Deadline, FingerCal,
+//  UsageStats, and the stats of the stores' own
+//  libraries) stay file-scope statics: a few words
+//  each, and a part per library would cost more in
+//  alignment padding than it saves.
+// ===================================================
+enum ArenaPart {
+  ARENA_DSP,          // GripControl: filter state, RMS window
+  ARENA_ADC_CAL,      // AdcCal: code -> volts table, sweep points
+  ARENA_QUALITY,      // SignalQuality: window accumulators
+  ARENA_ACTUATORS,    // Actuators: staged angles
+  ARENA_SCHED,        // Scheduler: per-task stats
+  ARENA_TELEMETRY,    // Teleplot: frame, decimators
+  ARENA_RECORDER,     // FlightRecorder: ring, snapshot slots
+  ARENA_PARTS
+};
+
+#ifndef ARENA_DSP_BUDGET
+#define ARENA_DSP_BUDGET        1024
+#endif
+#ifndef ARENA_ADC_CAL_BUDGET
+#define ARENA_ADC_CAL_BUDGET    17408
+#endif
+#ifndef ARENA_QUALITY_BUDGET
+#define ARENA_QUALITY_BUDGET    64
+#endif
+#ifndef ARENA_ACTUATORS_BUDGET
+#define ARENA_ACTUATORS_BUDGET  32
+#endif
+#ifndef ARENA_SCHED_BUDGET
+#define ARENA_SCHED_BUDGET      768
+#endif
+#ifndef ARENA_TELEMETRY_BUDGET
+#define ARENA_TELEMETRY_BUDGET  4096
+#endif
+#ifndef ARENA_RECORDER_BUDGET
+#define ARENA_RECORDER_BUDGET   73728
+#endif
+
+// Share of the ESP32's static DRAM the arena may take; framework
+// statics and the heap need the rest
+#ifndef ARENA_DRAM_MAX
+#define ARENA_DRAM_MAX          (96 * 1024)
+#endif
+
+#define ARENA_ALIGN             8
+
+constexpr uint32_t ARENA_BUDGET[ARENA_PARTS] = {
+  ARENA_DSP_BUDGET, ARENA_ADC_CAL_BUDGET, ARENA_QUALITY_BUDGET, ARENA_ACTUATORS_BUDGET,
+  ARENA_SCHED_BUDGET, ARENA_TELEMETRY_BUDGET, ARENA_RECORDER_BUDGET,
+};
+
+constexpr uint32_t arenaOffset(int part) {
+  return part == 0 ? 0
+       : arenaOffset(part - 1) + ((ARENA_BUDGET[part - 1] + ARENA_ALIGN - 1) & ~(uint32_t)(ARENA_ALIGN - 1));
+}
+
+#define ARENA_BYTES  arenaOffset(ARENA_PARTS)
+
+static_assert(ARENA_BYTES <= ARENA_DRAM_MAX, "arena budgets exceed ARENA_DRAM_MAX");
+
+struct alignas(ARENA_ALIGN) GripArena {
+  uint8_t bytes[ARENA_BYTES];
+};
+
+// Defined in Arena.cpp
+extern GRIP_STATE GripArena gripArena;
+
+// Power-on, before any store is used: constructs every
+// store in place (value-initialized: zeroed, or the
+// member initializers of a store like DspStore)
+void arenaInit();
+
+// The store of one part, constructed by arenaInit(). Stores
+// are never destroyed; each subsystem then fills its own at
+// power-on.
+template <typename T, ArenaPart P>
+inline T &arenaStore() {
+  static_assert(sizeof(T) <= ARENA_BUDGET[P], "store over its arena budget");
+  static_assert(alignof(T) <= ARENA_ALIGN, "store alignment over ARENA_ALIGN");
+  static_assert(std::is_trivially_destructible<T>::value, "arena stores are never destroyed");
+  constexpr uint32_t off = arenaOffset(P);
+  return *reinterpret_cast<T *>(gripArena.bytes + off);
+}
+
+// Build-time table, also read from the ELF by scripts/ram_report.py
+struct ArenaPartInfo {
+  char     name[12];
+  uint32_t used;
+  uint32_t budget;
+};
+
+extern const ArenaPartInfo arenaParts[ARENA_PARTS];
+
+struct HeapStats {
+  bool     sealed;
+  uint32_t allocs;     // after arenaSeal()
+  uint32_t bytes;
+};
+
+// End of setup(): from here on every allocation is counted
+void arenaSeal();
+// Usage task: log the first allocation after arenaSeal()
+void arenaCheckHeap();
+HeapStats arenaHeapStats();
+void arenaPrint();
@@ -0,0 +1,131 @@
+#include "ConfigStore.h"
+
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+static Preferences prefs;
+#else
+#include <stdio.h>
+static char nsName[96] = CONFIG_NAMESPACE;
+#endif
+
+#define CONFIG_MAX_RECORD 256
+
+// ===================================================
+//  CRC32 (IEEE, bitwise — records are tiny)
+// ===================================================
+uint32_t configCrc32(const void *data, size_t size) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < size; i++) {
+    crc ^= p[i];
+    for (int b = 0; b < 8; b++)
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// ===================================================
+//  BACKEND
+// ===================================================
+#ifdef ARDUINO
+
+bool configBegin(const char *ns) {
+  return prefs.begin(ns, false);
+}
+
+static size_t backendRead(const char *key, uint8_t *buf, size_t size) {
+  if (!prefs.isKey(key)) return 0;
+  return prefs.getBytes(key, buf, size);
+}
+
+static bool backendWrite(const char *key, const uint8_t *buf, size_t size) {
+  return prefs.putBytes(key, buf, size) == size;
+}
+
+bool configErase(const char *key) {
+  return prefs.remove(key);
+}
+
+#else
+
+bool configBegin(const char *ns) {
+  strncpy(nsName, ns, sizeof(nsName) - 1);
+  nsName[sizeof(nsName) - 1] = '\0';
+  return true;
+}
+
+// On host the namespace doubles as a path prefix, e.g. "/tmp/run1/semg"
+static void recordPath(const char *key, char *path, size_t len) {
+  snprintf(path, len, "%s_%s.bin", nsName, key);
+}
+
+static size_t backendRead(const char *key, uint8_t *buf, size_t size) {
+  if (!nsName[0]) return 0;
+  char path[160];
+  recordPath(key, path, sizeof(path));
+  FILE *f = fopen(path, "rb");
+  if (!f) return 0;
+  size_t n = fread(buf, 1, size, f);
+  fclose(f);
+  return n;
+}
+
+// Write to a temp file and rename so a crash never leaves a torn record
+static bool backendWrite(const char *key, const uint8_t *buf, size_t size) {
+  if (!nsName[0]) return true;
+  char path[160], tmp[168];
+  recordPath(key, path, sizeof(path));
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "wb");
+  if (!f) return false;
+  bool ok = fwrite(buf, 1, size, f) == size;
+  ok = (fclose(f) == 0) && ok;
+  return ok && rename(tmp, path) == 0;
+}
+
+bool configErase(const char *key) {
+  if (!nsName[0]) return true;
+  char path[160];
+  recordPath(key, path, sizeof(path));
+  return remove(path) == 0;
+}
+
+#endif
+
+// ===================================================
+//  RECORDS
+// ===================================================
+bool configLoad(const char *key, uint16_t version, void *data, size_t size) {
+  uint8_t buf[CONFIG_MAX_RECORD];
+  size_t total = sizeof(ConfigHeader) + size;
+  if (total > sizeof(buf)) return false;
+
+  if (backendRead(key, buf, total) != total) return false;
+
+  ConfigHeader hdr;
+  memcpy(&hdr, buf, sizeof(hdr));
+  if (hdr.magic != CONFIG_MAGIC) return false;
+  if (hdr.version != version || hdr.size != size) return false;
+  if (hdr.crc != configCrc32(buf + sizeof(hdr), size)) return false;
+
+  memcpy(data, buf + sizeof(hdr), size);
+  return true;
+}
+
+bool configSave(const char *key, uint16_t version, const void *data, size_t size) {
+  uint8_t buf[CONFIG_MAX_RECORD];
+  size_t total = sizeof(ConfigHeader) + size;
+  if (total > sizeof(buf)) return false;
+
+  ConfigHeader hdr;
+  hdr.magic   = CONFIG_MAGIC;
+  hdr.version = version;
+  hdr.size    = (uint16_t)size;
+  hdr.crc     = configCrc32(data, size);
+
+  memcpy(buf, &hdr, sizeof(hdr));
+  memcpy(buf + sizeof(hdr), data, size);
+  return backendWrite(key, buf, total);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================
+//  PERSISTENT CONFIGURATION STORE
+//
+//  Each record is stored under its own key as
+//  [header | payload]. The header carries a magic,
+//  the payload version and size, and a CRC32 of the
+//  payload; a record that fails any check is treated
+//  as absent so the caller falls back to defaults.
+//
+//  Target: NVS via Preferences.
+//  Host:   one file per key, "<namespace>_<key>.bin";
+//          an empty namespace disables persistence.
+// ===================================================
+#define CONFIG_MAGIC     0x474D4553UL   // "SEMG"
+#define CONFIG_NAMESPACE "semg"
+
+struct ConfigHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+};
+
+bool     configBegin(const char *ns = CONFIG_NAMESPACE);
+bool     configLoad(const char *key, uint16_t version, void *data, size_t size);
+bool     configSave(const char *key, uint16_t version, const void *data, size_t size);
+bool     configErase(const char *key);
+uint32_t configCrc32(const void *data, size_t size);
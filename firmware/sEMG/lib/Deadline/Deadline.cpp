@@ -0,0 +1,118 @@
+#include "Deadline.h"
+
+#include <Hal.h>
+#include <string.h>
+
+static GRIP_STATE DeadlineStats stats;
+static GRIP_STATE bool          haveSeq     = false;
+static GRIP_STATE uint32_t      lastSeq     = 0;
+static GRIP_STATE bool          inFlight    = false;
+static GRIP_STATE unsigned long arrivalUs   = 0;
+static GRIP_STATE uint32_t      peakPassUs  = 0;
+
+static GRIP_STATE unsigned long windowStart = 0;
+static GRIP_STATE uint32_t      windowBad   = 0;
+static GRIP_STATE int           badWindows  = 0;
+static GRIP_STATE bool          safeState   = false;   // latched until a clean window
+
+void deadlineReset() {
+  memset(&stats, 0, sizeof(stats));
+  haveSeq     = false;
+  inFlight    = false;
+  peakPassUs  = 0;
+  windowStart = halMillis();
+  windowBad   = 0;
+  badWindows  = 0;
+  safeState   = false;
+}
+
+// ===================================================
+//  SAMPLES
+// ===================================================
+void deadlineSample(unsigned long atUs, uint32_t seq) {
+  if (haveSeq && seq - lastSeq > 1) {
+    uint32_t lost = seq - lastSeq - 1;
+    stats.count[DL_LOST] += lost;
+    windowBad += lost;
+  }
+  haveSeq   = true;
+  lastSeq   = seq;
+  arrivalUs = atUs;
+  inFlight  = true;
+  stats.samples++;
+}
+
+void deadlineSampleDone(unsigned long nowUs) {
+  if (!inFlight) return;
+  inFlight = false;
+  unsigned long latency = nowUs - arrivalUs;
+  if (latency > stats.maxLatencyUs) stats.maxLatencyUs = latency;
+  if (latency > DL_SAMPLE_US) {
+    stats.count[DL_LATE]++;
+    windowBad++;
+  }
+}
+
+// ===================================================
+//  SERVO
+// ===================================================
+void deadlineServo(unsigned long nowUs, unsigned long releaseMs) {
+  // releaseMs * 1000 wraps with micros(), so the difference holds
+  long late = (long)(nowUs - releaseMs * 1000UL);
+  if (late <= 0) return;
+  if ((unsigned long)late > stats.maxServoLateUs) stats.maxServoLateUs = late;
+  if (late > DL_SERVO_SLACK_US) stats.count[DL_SERVO]++;
+}
+
+// ===================================================
+//  PASSES / OVERLOAD
+// ===================================================
+bool deadlinePass(unsigned long passUs, unsigned long nowMs) {
+  if (passUs > stats.wcetPassUs) stats.wcetPassUs = passUs;
+  if (passUs > peakPassUs) peakPassUs = passUs;
+  if (passUs > DL_SAMPLE_US) stats.count[DL_LONG_PASS]++;
+
+  if (nowMs - windowStart < DL_WINDOW_MS) return false;
+  windowStart = nowMs;
+  bool overloaded = windowBad >= DL_OVERLOAD_SAMPLES;
+  windowBad = 0;
+
+  if (!overloaded) {
+    badWindows = 0;
+    if (safeState) halPrintln(">> Overload cleared");
+    safeState = false;
+    return false;
+  }
+  if (++badWindows < DL_OVERLOAD_WINDOWS || safeState) return false;
+  safeState = true;
+  stats.safeStates++;
+  return true;
+}
+
+// ===================================================
+//  REPORT
+// ===================================================
+const DeadlineStats &deadlineStats() { return stats; }
+bool deadlineSafeState() { return safeState; }
+
+uint32_t deadlineOverruns() {
+  uint32_t n = 0;
+  for (int c = 0; c < DL_CLASS_COUNT; c++) n += stats.count[c];
+  return n;
+}
+
+uint32_t deadlineTakePeakUs() {
+  uint32_t p = peakPassUs;
+  peakPassUs = 0;
+  return p;
+}
+
+void deadlinePrint() {
+  halPrintf("DEADLINE samples=%lu late=%lu lost=%lu servo=%lu long=%lu safe=%lu\n",
+            (unsigned long)stats.samples, (unsigned long)stats.count[DL_LATE],
+            (unsigned long)stats.count[DL_LOST], (unsigned long)stats.count[DL_SERVO],
+            (unsigned long)stats.count[DL_LONG_PASS], (unsigned long)stats.safeStates);
+  halPrintf("DEADLINE wcet_pass=%lu us max_latency=%lu us max_servo_late=%lu us\n",
+            (unsigned long)stats.wcetPassUs, (unsigned long)stats.maxLatencyUs,
+            (unsigned long)stats.maxServoLateUs);
+}
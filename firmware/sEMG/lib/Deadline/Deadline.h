@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GripControl.h>
+
+// ===================================================
+//  DEADLINE MONITOR
+//
+//  Checks the loop against its real-time contract:
+//
+//  - every sample must be fully processed before the
+//    next one arrives (arrival is stamped by the timer
+//    ISR, completion after the recorder task). Samples
+//    the timer overwrote are found from gaps in the
+//    tick sequence
+//  - every servo step must start within
+//    DL_SERVO_SLACK_US of its scheduler release
+//  - no loop pass may take longer than a sample
+//    period; the worst pass is kept as the WCET
+//
+//  Late and lost samples are counted per
+//  DL_WINDOW_MS window. DL_OVERLOAD_WINDOWS windows in
+//  a row over DL_OVERLOAD_SAMPLES enter the safe
+//  state: the hand is forced open once and may not
+//  close again until a clean window clears it.
+//
+//  'm' prints the counters; Teleplot can stream them
+//  (TELEM_HEALTH fields).
+// ===================================================
+#define DL_SAMPLE_US         (1000000UL / SAMPLE_RATE_HZ)
+#define DL_SERVO_SLACK_US    1000
+#define DL_WINDOW_MS         1000
+#define DL_OVERLOAD_SAMPLES  100      // late + lost per window (10% at 1kHz)
+#define DL_OVERLOAD_WINDOWS  2
+
+enum DeadlineClass {
+  DL_LATE,          // processed after the next sample was due
+  DL_LOST,          // overwritten before it was taken
+  DL_SERVO,         // servo step started late
+  DL_LONG_PASS,     // one loop pass longer than a sample period
+  DL_CLASS_COUNT
+};
+
+struct DeadlineStats {
+  uint32_t count[DL_CLASS_COUNT];
+  uint32_t samples;
+  uint32_t wcetPassUs;     // worst loop pass since reset
+  uint32_t maxLatencyUs;   // worst arrival -> completion
+  uint32_t maxServoLateUs;
+  uint32_t safeStates;     // overload episodes that forced open
+};
+
+void deadlineReset();
+
+// Sample taken by the DSP task: ISR arrival stamp and tick number
+void deadlineSample(unsigned long arrivalUs, uint32_t seq);
+// That sample is fully processed
+void deadlineSampleDone(unsigned long nowUs);
+// Servo step starting at nowUs for a release at releaseMs
+void deadlineServo(unsigned long nowUs, unsigned long releaseMs);
+// End of a loop pass; true once when sustained overload starts
+bool deadlinePass(unsigned long passUs, unsigned long nowMs);
+// Overload safe state latched: the hand must stay open
+bool deadlineSafeState();
+
+const DeadlineStats &deadlineStats();
+// All classes together
+uint32_t deadlineOverruns();
+// Worst pass since the last call (Teleplot)
+uint32_t deadlineTakePeakUs();
+void     deadlinePrint();
@@ -0,0 +1,207 @@
+#include "EmgSynth.h"
+
+#include <math.h>
+
+#define ADC_CODES 4095.0f
+
+// ===================================================
+//  RANDOM (xorshift128+)
+// ===================================================
+static uint64_t splitmix64(uint64_t &x) {
+  uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+uint32_t EmgSynth::rand32() {
+  uint64_t s1 = rng[0];
+  const uint64_t s0 = rng[1];
+  rng[0] = s0;
+  s1 ^= s1 << 23;
+  rng[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+  return (uint32_t)((rng[1] + s0) >> 32);
+}
+
+float EmgSynth::uniform() {
+  return (int32_t)rand32() * (1.0f / 2147483648.0f);
+}
+
+// ===================================================
+//  SETUP
+// ===================================================
+EmgSynth::EmgSynth(const EmgSynthConfig &c) : cfg(c) {
+  uint64_t s = cfg.seed;
+  rng[0] = splitmix64(s);
+  rng[1] = splitmix64(s);
+
+  float w = 6.2831853f * cfg.humHz / cfg.sampleRateHz;
+  humCos = cosf(w);
+  humSin = sinf(w);
+  artifactDecay = expf(-1.0f / (cfg.artifactTauS * cfg.sampleRateHz));
+  if (cfg.artifactPerS > 0) {
+    float u = 0.5f * (uniform() + 1.0f);
+    nextArtifact = (uint64_t)(-logf(1.0f - u) / cfg.artifactPerS * cfg.sampleRateHz);
+  }
+
+  // The analytic noise gain below ignores bilinear warping; measure the
+  // real gain once and fold the error into every later retune
+  tuneBand(0);
+  float y1 = 0, y2 = 0, sum = 0;
+  uint64_t saved[2] = { rng[0], rng[1] };
+  for (int i = 0; i < 16384; i++) {
+    float x = uniform();
+    float y = b0 * x + y1;
+    y1 = -a1 * y + y2;
+    y2 = b2 * x - a2 * y;
+    if (i >= 1024) sum += y * y;
+  }
+  rng[0] = saved[0];
+  rng[1] = saved[1];
+  normCorr = 1.0f / (norm * sqrtf(sum / (16384 - 1024)));
+  tuneBand(0);
+
+  // Rest first; the first contraction starts after a rest interval
+  phase = RAMP_DOWN;
+  phaseLeft = 0;
+  nextPhase();
+}
+
+// RBJ band-pass between bandLow and bandHigh; fatigue compresses the
+// band toward lower frequencies (median-frequency drop)
+void EmgSynth::tuneBand(float f) {
+  float shift = 1.0f / (1.0f + f);
+  float lo = cfg.bandLowHz * shift, hi = cfg.bandHighHz * shift;
+  float nyq = 0.45f * cfg.sampleRateHz;
+  if (hi > nyq) hi = nyq;
+  float f0 = sqrtf(lo * hi);
+  float q  = f0 / (hi - lo);
+  float w0 = 6.2831853f * f0 / cfg.sampleRateHz;
+  float alpha = sinf(w0) / (2.0f * q);
+  float a0 = 1.0f + alpha;
+  b0 =  alpha / a0;
+  b2 = -alpha / a0;
+  a1 = -2.0f * cosf(w0) / a0;
+  a2 = (1.0f - alpha) / a0;
+
+  // Noise gain of the band-pass for unit-variance white input
+  // (uniform[-1,1) has variance 1/3): scale output to unit rms
+  float bw = (hi - lo) / (0.5f * cfg.sampleRateHz);
+  norm = normCorr / sqrtf(bw / 3.0f);
+}
+
+void EmgSynth::nextPhase() {
+  float fs = cfg.sampleRateHz;
+  float u  = 0.5f * (uniform() + 1.0f);
+  uint64_t ramp = (uint64_t)(cfg.rampS * fs) + 1;
+
+  switch (phase) {
+    case REST:
+      // Only draw when enabled, so plain corpora stay bit-identical
+      if (cfg.doubleProb > 0 && burstLeft == 0 && 0.5f * (uniform() + 1.0f) < cfg.doubleProb)
+        burstLeft = 2;
+      phase   = RAMP_UP;
+      onset   = pos;
+      target  = cfg.ampMinV + u * (cfg.ampMaxV - cfg.ampMinV);
+      phaseLeft = ramp;
+      envStep = target / ramp;
+      tuneBand(fatigue);
+      break;
+    case RAMP_UP:
+      phase = HOLD;
+      env = target;
+      envStep = 0;
+      if (burstLeft)
+        phaseLeft = (uint64_t)((cfg.doubleHoldMinS + u * (cfg.doubleHoldMaxS - cfg.doubleHoldMinS)) * fs) + 1;
+      else
+        phaseLeft = (uint64_t)((cfg.holdMinS + u * (cfg.holdMaxS - cfg.holdMinS)) * fs) + 1;
+      break;
+    case HOLD:
+      phase = RAMP_DOWN;
+      phaseLeft = ramp;
+      envStep = -env / ramp;
+      break;
+    case RAMP_DOWN: {
+      if (pos > 0) {
+        EmgLabel l = { onset, pos, target };
+        done.push_back(l);
+      }
+      phase = REST;
+      env = 0;
+      envStep = 0;
+      if (burstLeft && --burstLeft)
+        phaseLeft = (uint64_t)((cfg.doubleGapMinS + u * (cfg.doubleGapMaxS - cfg.doubleGapMinS)) * fs) + 1;
+      else
+        phaseLeft = (uint64_t)((cfg.restMinS + u * (cfg.restMaxS - cfg.restMinS)) * fs) + 1;
+      break;
+    }
+  }
+}
+
+// ===================================================
+//  GENERATE
+// ===================================================
+size_t EmgSynth::generate(uint16_t *out, size_t n) {
+  const float fs     = cfg.sampleRateHz;
+  const float scale  = ADC_CODES / cfg.fullScaleV;
+  const float floorV = cfg.floorV;
+  const float restV  = cfg.restNoiseV;
+  const float humV   = cfg.humV;
+  size_t i = 0;
+
+  while (i < n) {
+    if (phaseLeft == 0) nextPhase();
+    size_t run = n - i;
+    if (run > phaseLeft) run = phaseLeft;
+    if (nextArtifact - pos < run) run = (size_t)(nextArtifact - pos);
+    if (run == 0) {
+      // Artifact due now: electrode shift / cable tug
+      artifact += (uniform() < 0 ? -1.0f : 1.0f) * cfg.artifactV * (0.5f + 0.5f * fabsf(uniform()));
+      float u = 0.5f * (uniform() + 1.0f);
+      nextArtifact = pos + 1 + (uint64_t)(-logf(1.0f - u) / cfg.artifactPerS * fs);
+      continue;
+    }
+
+    float gain = 1.0f + fatigue;
+    float e = env, z1l = z1, z2l = z2;
+    float hc = humC, hs = humS, art = artifact;
+
+    for (size_t k = 0; k < run; k++) {
+      float x = uniform();
+      float y = b0 * x + z1l;
+      z1l = -a1 * y + z2l;
+      z2l = b2 * x - a2 * y;
+
+      float v = cfg.offsetV + e * gain * norm * y + restV * 1.7320508f * uniform()
+              + humV * hs + art;
+      e += envStep;
+      float c = hc * humCos - hs * humSin;
+      hs = hs * humCos + hc * humSin;
+      hc = c;
+      art *= artifactDecay;
+
+      float code = v < floorV ? 0.0f : v * scale + 0.5f;
+      if (code > ADC_CODES) code = ADC_CODES;
+      out[i + k] = (uint16_t)code;
+    }
+
+    // Renormalise the hum phasor so rounding never lets it drift
+    float m = 1.5f - 0.5f * (hc * hc + hs * hs);
+    humC = hc * m;
+    humS = hs * m;
+    env = e; z1 = z1l; z2 = z2l; artifact = art;
+
+    float secs = run / fs;
+    if (phase == REST) {
+      fatigue -= cfg.recoveryPerS * secs;
+      if (fatigue < 0) fatigue = 0;
+    } else {
+      fatigue += cfg.fatiguePerS * secs;
+    }
+
+    pos += run;
+    phaseLeft -= run;
+    i += run;
+  }
+  return n;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ===================================================
+//  SYNTHETIC sEMG GENERATOR (host only)
+//
+//  Produces 12-bit ADC codes as the firmware would
+//  read them on EMG_PIN (analogReadResolution(12),
+//  ADC_11db): band-limited noise, amplitude-modulated
+//  by a random rest / ramp / hold contraction
+//  schedule, with optional fatigue, mains hum and
+//  motion artifacts, then quantized and clipped.
+//
+//  Every contraction is recorded as a ground-truth
+//  label (ramp start .. first rest sample). A
+//  deliberate double flex is two labels closer than
+//  restMinS.
+// ===================================================
+struct EmgSynthConfig {
+  uint64_t seed         = 1;
+  float sampleRateHz    = 1000.0f;
+
+  // Contraction schedule (seconds)
+  float restMinS        = 1.0f;
+  float restMaxS        = 3.0f;
+  float holdMinS        = 0.5f;
+  float holdMaxS        = 2.5f;
+  float rampS           = 0.08f;
+
+  // Deliberate double flexes: this fraction of
+  // contractions become two short flexes
+  float doubleProb      = 0.0f;
+  float doubleHoldMinS  = 0.35f;
+  float doubleHoldMaxS  = 0.55f;
+  float doubleGapMinS   = 0.55f;
+  float doubleGapMaxS   = 0.75f;
+
+  // Muscle component at plateau, volts rms
+  float ampMinV         = 0.10f;
+  float ampMaxV         = 0.40f;
+  float bandLowHz       = 20.0f;
+  float bandHighHz      = 350.0f;
+  float restNoiseV      = 0.01f;
+
+  // Fatigue: gain growth and spectral compression per
+  // second of contraction, recovered during rest
+  float fatiguePerS     = 0.0f;
+  float recoveryPerS    = 0.02f;
+
+  float humV            = 0.0f;
+  float humHz           = 50.0f;
+
+  float artifactPerS    = 0.0f;    // mean artifact rate
+  float artifactV       = 0.6f;
+  float artifactTauS    = 0.15f;
+
+  // Front end: bias point and ADC model
+  float offsetV         = 1.65f;   // MIDPOINT
+  float fullScaleV      = 3.3f;    // VREF used by processEMG()
+  float floorV          = 0.0f;    // inputs below read as 0
+};
+
+struct EmgLabel {
+  uint64_t onset;
+  uint64_t offset;
+  float    amp;
+};
+
+class EmgSynth {
+public:
+  explicit EmgSynth(const EmgSynthConfig &cfg);
+
+  // Fill out[0..n) with ADC codes; returns n
+  size_t generate(uint16_t *out, size_t n);
+
+  uint64_t position() const { return pos; }
+  // Completed contractions so far
+  const std::vector<EmgLabel> &labels() const { return done; }
+  void clearLabels() { done.clear(); }
+
+private:
+  enum Phase { REST, RAMP_UP, HOLD, RAMP_DOWN };
+
+  void     nextPhase();
+  void     tuneBand(float fatigue);
+  uint32_t rand32();
+  float    uniform();   // [-1, 1)
+
+  EmgSynthConfig cfg;
+  uint64_t pos = 0;
+  uint64_t rng[2];
+
+  Phase    phase = REST;
+  uint64_t phaseLeft = 0;
+  float    env = 0, envStep = 0, target = 0;
+  uint64_t onset = 0;
+  int      burstLeft = 0;    // flexes left in a double flex
+  float    fatigue = 0;
+
+  // Band-pass biquad (transposed direct form II)
+  float b0 = 0, b2 = 0, a1 = 0, a2 = 0, z1 = 0, z2 = 0;
+  float norm = 1, normCorr = 1;
+
+  float humC = 1, humS = 0, humCos = 1, humSin = 0;
+  float artifact = 0, artifactDecay = 0;
+  uint64_t nextArtifact = UINT64_MAX;
+
+  std::vector<EmgLabel> done;
+};
@@ -0,0 +1,125 @@
+#include "FingerCal.h"
+
+#include <Actuators.h>
+#include <ConfigStore.h>
+#include <Hal.h>
+#include <string.h>
+
+#define KNOT_CMD(k) ((k) * SERVO_CLOSED / (FINGER_KNOTS - 1))
+
+static const char *KNOT_NAMES[FINGER_KNOTS] = { "open", "1/4", "1/2", "3/4", "closed" };
+
+static GRIP_STATE FingerRecord table;
+static GRIP_STATE FingerRecord saved;     // restored on abort
+
+static GRIP_STATE bool active = false;
+static GRIP_STATE int  calFinger, calKnot, calAngle;
+
+// ===================================================
+//  TABLE
+// ===================================================
+void fingerCalDefaults() {
+  for (int f = 0; f < NUM_FINGERS; f++)
+    for (int k = 0; k < FINGER_KNOTS; k++)
+      table.angle[f][k] = (uint8_t)KNOT_CMD(k);
+  active = false;
+}
+
+bool fingerCalLoad() {
+  FingerRecord rec;
+  if (!configLoad(FINGER_KEY, FINGER_VERSION, &rec, sizeof(rec))) return false;
+  for (int f = 0; f < NUM_FINGERS; f++)
+    for (int k = 0; k < FINGER_KNOTS; k++)
+      if (rec.angle[f][k] > FINGER_ANGLE_MAX) return false;
+  table = rec;
+  return true;
+}
+
+bool fingerCalSave() {
+  return configSave(FINGER_KEY, FINGER_VERSION, &table, sizeof(table));
+}
+
+int fingerAngle(int finger, int command) {
+  if (command <= SERVO_OPEN)   return table.angle[finger][0];
+  if (command >= SERVO_CLOSED) return table.angle[finger][FINGER_KNOTS - 1];
+
+  int k = command * (FINGER_KNOTS - 1) / SERVO_CLOSED;   // segment
+  int c0 = KNOT_CMD(k), span = KNOT_CMD(k + 1) - c0;
+  int a0 = table.angle[finger][k];
+  int num = (table.angle[finger][k + 1] - a0) * (command - c0);
+  // Round half away from zero, symmetric for falling tables
+  int d = num >= 0 ? (num + span / 2) / span : -((-num + span / 2) / span);
+  return a0 + d;
+}
+
+// ===================================================
+//  GUIDED CALIBRATION
+// ===================================================
+static void prompt() {
+  halPrintf("FINGER CAL finger %d, %s: angle %d  ([ ] jog, n accept, g abort)\n",
+            calFinger, KNOT_NAMES[calKnot], calAngle);
+}
+
+static void beginPoint() {
+  calAngle = table.angle[calFinger][calKnot];
+  // Other fingers stay open and out of the way
+  for (int f = 0; f < NUM_FINGERS; f++)
+    actSet(f, f == calFinger ? calAngle : table.angle[f][0]);
+  actFlush();
+  prompt();
+}
+
+static void finish() {
+  active = false;
+  for (int f = 0; f < NUM_FINGERS; f++) actSet(f, fingerAngle(f, servoAngle));
+  actFlush();
+}
+
+void fingerCalStart() {
+  if (handState != IDLE) {
+    halPrintln("FINGER CAL needs the hand open and idle");
+    return;
+  }
+  saved     = table;
+  active    = true;
+  calFinger = 0;
+  calKnot   = 0;
+  beginPoint();
+}
+
+bool fingerCalActive() { return active; }
+
+bool fingerCalCommand(char cmd) {
+  if (!active) return false;
+  switch (cmd) {
+    case '[':
+    case ']':
+      calAngle += cmd == ']' ? 1 : -1;
+      if (calAngle < 0) calAngle = 0;
+      if (calAngle > FINGER_ANGLE_MAX) calAngle = FINGER_ANGLE_MAX;
+      actSet(calFinger, calAngle);
+      actFlush();
+      prompt();
+      return true;
+
+    case 'n':
+      table.angle[calFinger][calKnot] = (uint8_t)calAngle;
+      if (++calKnot == FINGER_KNOTS) {
+        calKnot = 0;
+        if (++calFinger == NUM_FINGERS) {
+          finish();
+          halPrintf("FINGER CAL %s\n", fingerCalSave() ? "saved" : "applied (not saved)");
+          return true;
+        }
+      }
+      beginPoint();
+      return true;
+
+    case 'g':
+      table = saved;
+      finish();
+      halPrintln("FINGER CAL aborted");
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GripControl.h>
+
+// ===================================================
+//  PER-FINGER TENDON COMPENSATION
+//
+//  servoAngle is a normalized grip command (SERVO_OPEN
+//  .. SERVO_CLOSED). Each finger maps it to its own
+//  servo angle through FINGER_KNOTS knots, so fingers
+//  with different tendon routing reach the object
+//  together:
+//
+//  - knots sit at evenly spaced commands (0, 32, 65,
+//    97, 130); between them the angle is interpolated
+//    with integer math only, once per servo step
+//  - the default table is the identity, i.e. the old
+//    moveAllFingers() behaviour
+//
+//  Guided calibration ('g', hand open): for each
+//  finger and knot, the finger is driven to its stored
+//  angle. The user jogs it with '[' / ']' until the
+//  fingertip sits on the knot's flexion mark (open, a
+//  quarter, half, three quarters, closed on the
+//  reference object) and accepts with 'n'. The table
+//  is saved after the last finger; 'g' again aborts.
+// ===================================================
+#define FINGER_KNOTS      5
+#define FINGER_ANGLE_MAX  180
+#define FINGER_KEY        "fingers"
+#define FINGER_VERSION    1
+
+struct FingerRecord {
+  uint8_t angle[NUM_FINGERS][FINGER_KNOTS];
+};
+
+// Identity tables (power-on)
+void fingerCalDefaults();
+bool fingerCalLoad();
+bool fingerCalSave();
+
+// Servo angle for `finger` at grip command `command`
+int  fingerAngle(int finger, int command);
+
+// Guided calibration
+void fingerCalStart();
+bool fingerCalActive();
+// Handles '[', ']', 'n' and 'g' while active; false if not consumed
+bool fingerCalCommand(char cmd);
@@ -0,0 +1,321 @@
+#include "FlightRecorder.h"
+
+#include <ConfigStore.h>
+#include <Hal.h>
+#include <string.h>
+
+#define REC_RING_MASK (REC_RING_SAMPLES - 1)
+
+// ===================================================
+//  STATE
+// ===================================================
+enum CaptureState { CAP_IDLE, CAP_POST, CAP_ENCODE };
+
+static inline RecStore &rec() { return arenaStore<RecStore, ARENA_RECORDER>(); }
+
+static GRIP_STATE uint32_t count     = 0;   // samples ever stored
+static GRIP_STATE unsigned long lastUs = 0;
+
+static GRIP_STATE uint8_t  triggers  = REC_TRIG_DEFAULT;
+static GRIP_STATE uint16_t preLen    = REC_PRE_DEFAULT;
+static GRIP_STATE uint16_t postLen   = REC_POST_DEFAULT;
+
+static GRIP_STATE CaptureState capState = CAP_IDLE;
+static GRIP_STATE uint32_t capStart, capTrig, capEnd, encodePos;
+static GRIP_STATE uint8_t  capTrigger;
+static GRIP_STATE uint32_t capMs;
+static GRIP_STATE int      capSlot;
+static GRIP_STATE int16_t  prevRaw, prevFilt;
+static GRIP_STATE uint8_t  prevState;
+
+static GRIP_STATE uint32_t slotSeq = 0;
+static GRIP_STATE uint16_t nextId  = 0;
+static GRIP_STATE RecStats stats;
+
+// Dump cursor
+static GRIP_STATE bool     dumping = false;
+static GRIP_STATE int      dumpCount, dumpIdx;
+static GRIP_STATE uint32_t dumpOff;
+static GRIP_STATE bool     dumpBegun;
+
+// ===================================================
+//  CONFIG
+// ===================================================
+void recorderReset() {
+  count = 0;
+  lastUs = 0;
+  triggers = REC_TRIG_DEFAULT;
+  preLen = REC_PRE_DEFAULT;
+  postLen = REC_POST_DEFAULT;
+  capState = CAP_IDLE;
+  for (int i = 0; i < REC_SLOTS; i++) rec().slots[i].used = false;
+  slotSeq = 0;
+  nextId = 0;
+  memset(&stats, 0, sizeof(stats));
+  dumping = false;
+}
+
+void recorderSetTriggers(uint8_t mask) { triggers = mask; }
+
+void recorderSetWindow(uint16_t pre, uint16_t post) {
+  // Keep the encoder's margin from the static_assert in the header
+  if (pre + post + 4 * REC_ENCODE_CHUNK >= REC_RING_SAMPLES) return;
+  preLen = pre;
+  postLen = post;
+}
+
+const RecStats &recorderStats() { return stats; }
+
+// ===================================================
+//  1kHz PATH
+// ===================================================
+void recorderTrigger(uint8_t trigger) {
+  if (!(triggers & trigger)) return;
+  if (capState != CAP_IDLE) { stats.suppressed++; return; }
+  uint32_t pre = count < preLen ? count : preLen;
+  capStart   = count - pre;
+  capTrig    = count;
+  capEnd     = count + postLen;
+  capTrigger = trigger;
+  capMs      = halMillis();
+  capState   = CAP_POST;
+}
+
+void recorderSample(int adc, float filtered, uint8_t state, unsigned long nowUs) {
+  float f = filtered * REC_FILT_SCALE;
+  if (f >  32767.0f) f =  32767.0f;
+  if (f < -32768.0f) f = -32768.0f;
+
+  RecStore &r = rec();
+  uint32_t i = count & REC_RING_MASK;
+  uint8_t  before = r.ringState[(count - 1) & REC_RING_MASK];
+  r.ringRaw[i]   = (int16_t)adc;
+  r.ringFilt[i]  = (int16_t)f;
+  r.ringState[i] = state;
+
+  // Triggers fire before the count advances, so this sample is the
+  // first of the post window
+  if (count > 0) {
+    if (nowUs - lastUs > REC_OVERRUN_US) {
+      stats.overruns++;
+      recorderTrigger(REC_TRIG_OVERRUN);
+    }
+    if ((state ^ before) & REC_STATE_MASK) recorderTrigger(REC_TRIG_TRANSITION);
+  }
+  count++;
+  lastUs = nowUs;
+}
+
+// ===================================================
+//  ENCODER — zigzag varint of int16 deltas
+// ===================================================
+static inline uint8_t *putDelta(uint8_t *p, int32_t d) {
+  uint32_t z = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+  while (z >= 0x80) { *p++ = (uint8_t)(z | 0x80); z >>= 7; }
+  *p++ = (uint8_t)z;
+  return p;
+}
+
+static inline const uint8_t *getDelta(const uint8_t *p, const uint8_t *end, int32_t *d) {
+  uint32_t z = 0;
+  for (int shift = 0; p < end && shift < 21; shift += 7) {
+    uint8_t b = *p++;
+    z |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) { *d = (int32_t)(z >> 1) ^ -(int32_t)(z & 1); return p; }
+  }
+  return nullptr;
+}
+
+// A free slot, else the oldest one the dump is not reading right now
+static int pickSlot() {
+  RecStore &r = rec();
+  int best = -1;
+  for (int i = 0; i < REC_SLOTS; i++) {
+    if (!r.slots[i].used) return i;
+    if (dumping && dumpIdx < dumpCount && r.dumpOrder[dumpIdx] == i) continue;
+    if (best < 0 || (int32_t)(r.slots[i].seq - r.slots[best].seq) < 0) best = i;
+  }
+  return best;
+}
+
+static void finishCapture(bool truncated) {
+  RecSlot &s = rec().slots[capSlot];
+  s.hdr.truncated = truncated;
+  s.seq  = slotSeq++;
+  s.used = true;
+  capState = CAP_IDLE;
+}
+
+static void encodeChunk() {
+  // The writer lapped the encoder: the window is gone
+  if (count - encodePos >= REC_RING_SAMPLES) {
+    stats.lost++;
+    capState = CAP_IDLE;
+    return;
+  }
+
+  RecStore &r = rec();
+  RecSlot  &s = r.slots[capSlot];
+  uint8_t *p   = s.data + s.hdr.bytes;
+  uint8_t *end = s.data + REC_SLOT_BYTES;
+  for (int n = 0; n < REC_ENCODE_CHUNK && encodePos < capEnd; n++, encodePos++) {
+    if (end - p < 9) {           // worst case: three 3-byte deltas
+      s.hdr.bytes = (uint16_t)(p - s.data);
+      finishCapture(true);
+      return;
+    }
+    uint32_t i = encodePos & REC_RING_MASK;
+    p = putDelta(p, (int32_t)r.ringRaw[i]  - prevRaw);
+    p = putDelta(p, (int32_t)r.ringFilt[i] - prevFilt);
+    p = putDelta(p, (int32_t)r.ringState[i] - prevState);
+    prevRaw   = r.ringRaw[i];
+    prevFilt  = r.ringFilt[i];
+    prevState = r.ringState[i];
+    s.hdr.samples++;
+  }
+  s.hdr.bytes = (uint16_t)(p - s.data);
+  if (encodePos == capEnd) finishCapture(false);
+}
+
+// ===================================================
+//  DUMP — one line per pass, only when the UART has
+//  room for it
+// ===================================================
+static void dumpLine() {
+  if (halSerialTxFree() < 128) return;
+
+  if (dumpIdx >= dumpCount) {
+    halPrintf("REC DONE %d\n", dumpCount);
+    dumping = false;
+    return;
+  }
+  RecStore &r = rec();
+  RecSlot  &s = r.slots[r.dumpOrder[dumpIdx]];
+  if (!s.used || s.seq != r.dumpSeq[dumpIdx]) {   // reused since the dump began
+    dumpIdx++;
+    dumpOff = 0;
+    dumpBegun = false;
+    return;
+  }
+
+  if (!dumpBegun) {
+    halPrintf("REC BEGIN id=%u trig=%u ms=%lu pre=%u n=%u bytes=%u trunc=%u\n",
+              s.hdr.id, s.hdr.trigger, (unsigned long)s.hdr.triggerMs,
+              s.hdr.pre, s.hdr.samples, s.hdr.bytes, s.hdr.truncated);
+    dumpBegun = true;
+    return;
+  }
+  if (dumpOff >= s.hdr.bytes) {
+    halPrintf("REC END id=%u crc=%08lx\n", s.hdr.id,
+              (unsigned long)configCrc32(s.data, s.hdr.bytes));
+    dumpIdx++;
+    dumpOff = 0;
+    dumpBegun = false;
+    return;
+  }
+
+  static_assert(sizeof("REC \n") + 2 * REC_DUMP_BYTES <= HAL_PRINTF_MAX,
+                "dump line longer than halPrintf prints");
+  static const char HEX[] = "0123456789abcdef";
+  char line[2 * REC_DUMP_BYTES + 1];
+  uint32_t n = s.hdr.bytes - dumpOff;
+  if (n > REC_DUMP_BYTES) n = REC_DUMP_BYTES;
+  for (uint32_t k = 0; k < n; k++) {
+    uint8_t b = s.data[dumpOff + k];
+    line[2 * k]     = HEX[b >> 4];
+    line[2 * k + 1] = HEX[b & 15];
+  }
+  line[2 * n] = '\0';
+  halPrintf("REC %s\n", line);
+  dumpOff += n;
+}
+
+void recorderStartDump() {
+  RecStore &r = rec();
+  dumpCount = 0;
+  for (int i = 0; i < REC_SLOTS; i++) {
+    if (!r.slots[i].used) continue;
+    // Insertion sort by capture order
+    int k = dumpCount++;
+    while (k > 0 && (int32_t)(r.slots[i].seq - r.dumpSeq[k - 1]) < 0) {
+      r.dumpOrder[k] = r.dumpOrder[k - 1];
+      r.dumpSeq[k]   = r.dumpSeq[k - 1];
+      k--;
+    }
+    r.dumpOrder[k] = i;
+    r.dumpSeq[k]   = r.slots[i].seq;
+  }
+  dumpIdx = 0;
+  dumpOff = 0;
+  dumpBegun = false;
+  dumping = true;
+}
+
+// ===================================================
+//  TICK
+// ===================================================
+void recorderTick() {
+  if (capState == CAP_POST && (int32_t)(count - capEnd) >= 0) {
+    capSlot = pickSlot();
+    RecSlot &s = rec().slots[capSlot];
+    s.used = false;
+    memset(&s.hdr, 0, sizeof(s.hdr));
+    s.hdr.id        = nextId++;
+    s.hdr.trigger   = capTrigger;
+    s.hdr.triggerMs = capMs;
+    s.hdr.pre       = (uint16_t)(capTrig - capStart);
+    encodePos = capStart;
+    prevRaw = prevFilt = 0;
+    prevState = 0;
+    stats.captures++;
+    capState = CAP_ENCODE;
+  }
+  if (capState == CAP_ENCODE) encodeChunk();
+  if (dumping) dumpLine();
+}
+
+// ===================================================
+//  ACCESS
+// ===================================================
+int recorderSnapshotCount() {
+  int n = 0;
+  for (int i = 0; i < REC_SLOTS; i++) n += rec().slots[i].used;
+  return n;
+}
+
+bool recorderSnapshot(int index, RecSnapshot *hdr, const uint8_t **payload) {
+  RecStore &r = rec();
+  int order[REC_SLOTS], n = 0;
+  for (int i = 0; i < REC_SLOTS; i++) {
+    if (!r.slots[i].used) continue;
+    int k = n++;
+    while (k > 0 && (int32_t)(r.slots[i].seq - r.slots[order[k - 1]].seq) < 0) {
+      order[k] = order[k - 1];
+      k--;
+    }
+    order[k] = i;
+  }
+  if (index < 0 || index >= n) return false;
+  *hdr = r.slots[order[index]].hdr;
+  *payload = r.slots[order[index]].data;
+  return true;
+}
+
+size_t recorderDecode(const uint8_t *payload, size_t bytes, RecSample *out, size_t max) {
+  const uint8_t *p = payload, *end = payload + bytes;
+  int32_t raw = 0, filt = 0, state = 0, d;
+  size_t n = 0;
+  while (n < max && p < end) {
+    if (!(p = getDelta(p, end, &d))) break;
+    raw += d;
+    if (!(p = getDelta(p, end, &d))) break;
+    filt += d;
+    if (!(p = getDelta(p, end, &d))) break;
+    state += d;
+    out[n].raw   = (int16_t)raw;
+    out[n].filt  = (int16_t)filt;
+    out[n].state = (uint8_t)state;
+    n++;
+  }
+  return n;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+
+// ===================================================
+//  FLIGHT RECORDER
+//
+//  Always-on ring of the last REC_RING_SAMPLES samples
+//  (raw ADC, filtered signal, hand/muscle state). A
+//  trigger freezes a window of REC_PRE_DEFAULT samples
+//  before it and REC_POST_DEFAULT after it:
+//
+//  - the 1kHz path only stores three values and
+//    compares the state; nothing else runs per sample
+//  - once the post window is in, recorderTick()
+//    delta-codes the window into a snapshot slot a
+//    chunk per loop pass, well ahead of the ring
+//    wrapping over it
+//  - snapshots are zigzag varints of the int16
+//    deltas, usually 3-4 bytes per sample; the oldest
+//    slot is reused when all are full
+//
+//  'x' captures by hand, 'd' dumps all snapshots as
+//  "REC ..." hex lines, paced by free UART space so
+//  the dump never blocks the loop.
+// ===================================================
+#define REC_RING_SAMPLES   4096        // ~4 s at 1kHz, power of two
+#define REC_PRE_DEFAULT    2000
+#define REC_POST_DEFAULT   1000
+#define REC_SLOTS          3
+#define REC_SLOT_BYTES     16384
+#define REC_ENCODE_CHUNK   64          // samples coded per loop pass
+#define REC_FILT_SCALE     4096.0f     // filtered volts -> int16 (~1/3 ADC LSB)
+#define REC_OVERRUN_US     1500        // sample gap counted as an overrun
+#define REC_DUMP_BYTES     48          // payload bytes per dump line
+
+static_assert((REC_RING_SAMPLES & (REC_RING_SAMPLES - 1)) == 0, "ring size must be a power of two");
+static_assert(REC_PRE_DEFAULT + REC_POST_DEFAULT + 4 * REC_ENCODE_CHUNK < REC_RING_SAMPLES,
+              "capture window must leave room for the encoder");
+
+// Trigger sources (bit mask)
+#define REC_TRIG_TRANSITION  0x01      // any hand-state change
+#define REC_TRIG_FORCE_OPEN  0x02      // 'o' command
+#define REC_TRIG_OVERRUN     0x04      // missed 1kHz samples
+#define REC_TRIG_MANUAL      0x08      // 'x' command
+#define REC_TRIG_DEFAULT     (REC_TRIG_TRANSITION | REC_TRIG_FORCE_OPEN | \
+                              REC_TRIG_OVERRUN | REC_TRIG_MANUAL)
+
+// Packed into each state byte
+#define REC_STATE_MASK       0x03      // HandState
+#define REC_STATE_MUSCLE     0x04      // muscleActive
+
+struct RecSnapshot {
+  uint16_t id;
+  uint8_t  trigger;      // one REC_TRIG_* bit
+  uint8_t  truncated;    // slot filled before the post window ended
+  uint32_t triggerMs;
+  uint16_t pre;          // samples before the trigger
+  uint16_t samples;      // samples coded
+  uint16_t bytes;        // payload bytes used
+  uint16_t reserved;
+};
+
+struct RecSample {
+  int16_t raw;           // ADC code
+  int16_t filt;          // filtered volts * REC_FILT_SCALE
+  uint8_t state;
+};
+
+struct RecSlot {
+  RecSnapshot hdr;
+  uint32_t    seq;       // capture order, for oldest-first
+  bool        used;
+  uint8_t     data[REC_SLOT_BYTES];
+};
+
+// Sample ring, snapshot slots, dump order (lib/Arena, ARENA_RECORDER)
+struct RecStore {
+  int16_t  ringRaw[REC_RING_SAMPLES];
+  int16_t  ringFilt[REC_RING_SAMPLES];
+  uint8_t  ringState[REC_RING_SAMPLES];
+  RecSlot  slots[REC_SLOTS];
+  int      dumpOrder[REC_SLOTS];
+  uint32_t dumpSeq[REC_SLOTS];
+};
+
+struct RecStats {
+  uint32_t captures;
+  uint32_t suppressed;   // triggers while a capture was in progress
+  uint32_t overruns;
+  uint32_t lost;         // captures overwritten before they were coded
+};
+
+void recorderReset();
+void recorderSetTriggers(uint8_t mask);
+void recorderSetWindow(uint16_t pre, uint16_t post);
+
+// 1kHz path: one sample, O(1)
+void recorderSample(int adc, float filtered, uint8_t state, unsigned long nowUs);
+void recorderTrigger(uint8_t trigger);
+// Once per loop pass: encodes pending captures, paces dumps
+void recorderTick();
+
+void recorderStartDump();
+const RecStats &recorderStats();
+
+// Snapshot access (host tools / tests)
+int  recorderSnapshotCount();
+// Copies snapshot `i` (0 = oldest) and its payload; false if absent
+bool recorderSnapshot(int i, RecSnapshot *hdr, const uint8_t **payload);
+// Decodes up to `max` samples; returns the number decoded
+size_t recorderDecode(const uint8_t *payload, size_t bytes, RecSample *out, size_t max);
@@ -0,0 +1,110 @@
+#include "Gesture.h"
+
+#include <Hal.h>
+#include <string.h>
+
+static constexpr GesturePattern PATTERNS[] = GESTURE_PATTERNS;
+static constexpr GestureAutomaton AUTOMATON = gestureBuild(PATTERNS);
+static_assert(!AUTOMATON.error, "GESTURE_PATTERNS: bad token, duplicate or too many states");
+
+static const uint8_t     MODE_MASKS[GRIP_MODE_COUNT] = GRIP_MODE_MASKS;
+static const char *const MODE_NAMES[GRIP_MODE_COUNT] = GRIP_MODE_NAMES;
+
+static GRIP_STATE GestureStats  stats;
+static GRIP_STATE int           node      = 0;       // trie state
+static GRIP_STATE bool          wasActive = false;
+static GRIP_STATE bool          longSent  = false;   // L already emitted for this flex
+static GRIP_STATE unsigned long edgeMs    = 0;       // last muscleActive edge
+static GRIP_STATE int           selected  = GRIP_POWER;
+static GRIP_STATE int           latched   = GRIP_POWER;
+
+void gestureReset() {
+  memset(&stats, 0, sizeof(stats));
+  node      = 0;
+  wasActive = false;
+  longSent  = false;
+  edgeMs    = 0;
+  selected  = GRIP_POWER;
+  latched   = GRIP_POWER;
+}
+
+// ===================================================
+//  DECODER
+// ===================================================
+static GestureAction fire(unsigned long now) {
+  GestureAction a = AUTOMATON.accept[node];
+  if (a == GESTURE_NONE) stats.aborted++;
+  else { stats.detections++; stats.lastMs = now; }
+  node = 0;
+  return a;
+}
+
+// Walk one token; fires at once when nothing longer can match
+static GestureAction step(int token, unsigned long now) {
+  stats.tokens++;
+  int n = AUTOMATON.next[node][token];
+  if (n < 0) {
+    if (node != 0) stats.aborted++;
+    node = 0;
+    return GESTURE_NONE;
+  }
+  node = n;
+  return AUTOMATON.leaf[node] ? fire(now) : GESTURE_NONE;
+}
+
+GestureAction gestureUpdate(bool active, unsigned long now) {
+  unsigned long held = now - edgeMs;
+
+  if (active != wasActive) {
+    wasActive = active;
+    edgeMs    = now;
+    if (active) {
+      longSent = false;
+      return GESTURE_NONE;
+    }
+    // Released: a short flex is a token; a medium one ends the sequence
+    if (longSent) return GESTURE_NONE;
+    if (held <= GESTURE_SHORT_MS) return step(GT_SHORT, now);
+    if (node != 0) { stats.aborted++; node = 0; }
+    return GESTURE_NONE;
+  }
+
+  if (active) {
+    if (!longSent && held >= GESTURE_LONG_MS) {
+      longSent = true;
+      return step(GT_LONG, now);
+    }
+    return GESTURE_NONE;
+  }
+  // Pause long enough: the sequence is complete
+  if (node != 0 && held >= GESTURE_GAP_MS) return fire(now);
+  return GESTURE_NONE;
+}
+
+// ===================================================
+//  GRIP MODES
+// ===================================================
+void gripModeApply(GestureAction a) {
+  switch (a) {
+    case GESTURE_NEXT_MODE:  selected = (selected + 1) % GRIP_MODE_COUNT; break;
+    case GESTURE_PREV_MODE:  selected = (selected + GRIP_MODE_COUNT - 1) % GRIP_MODE_COUNT; break;
+    case GESTURE_POWER_MODE: selected = GRIP_POWER; break;
+    default: return;
+  }
+  halPrintf(">> Grip mode -> %s\n", MODE_NAMES[selected]);
+}
+
+void        gripModeLatch()  { latched = selected; }
+uint8_t     gripModeMask()   { return MODE_MASKS[latched]; }
+const char *gripModeName()   { return MODE_NAMES[selected]; }
+
+// ===================================================
+//  REPORT
+// ===================================================
+const GestureStats &gestureStats() { return stats; }
+
+void gesturePrint() {
+  halPrintf("GESTURE mode=%s tokens=%lu detections=%lu aborted=%lu\n", gripModeName(),
+            (unsigned long)stats.tokens, (unsigned long)stats.detections,
+            (unsigned long)stats.aborted);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GripControl.h>
+
+// ===================================================
+//  GESTURE DECODER / GRIP MODES
+//
+//  Patterns of flexes select the grip mode. The input
+//  is the muscleActive edges updateMuscle() already
+//  makes, turned into tokens:
+//
+//  - S: a flex released within GESTURE_SHORT_MS
+//  - L: a flex held past GESTURE_LONG_MS (emitted the
+//    moment it gets there, not at release)
+//  - anything in between, or a pause longer than
+//    GESTURE_GAP_MS, ends the sequence
+//
+//  The tokens walk a trie built at compile time from
+//  GESTURE_PATTERNS. A pattern fires as soon as no
+//  longer pattern can still match, otherwise when the
+//  pause after it reaches GESTURE_GAP_MS, so every
+//  decision lands at most GESTURE_GAP_MS after the
+//  last edge.
+//
+//  The decoder only listens: flexes still close the
+//  hand as before. A new mode takes effect at the
+//  next IDLE -> CLOSING.
+// ===================================================
+#define GESTURE_SHORT_MS     900
+#define GESTURE_LONG_MS      1500
+#define GESTURE_GAP_MS       800
+#define GESTURE_MAX_STATES   16
+#define GESTURE_MAX_TOKENS   6
+
+enum GestureToken { GT_SHORT, GT_LONG, GT_COUNT };
+
+enum GestureAction : uint8_t {
+  GESTURE_NONE,
+  GESTURE_NEXT_MODE,
+  GESTURE_PREV_MODE,
+  GESTURE_POWER_MODE,
+};
+
+struct GesturePattern {
+  const char   *tokens;   // 'S' / 'L'
+  GestureAction action;
+};
+
+// Double flex: next mode. Triple flex: previous mode.
+// Double flex then hold: back to the power grip.
+#define GESTURE_PATTERNS {                 \
+  { "SS",  GESTURE_NEXT_MODE  },           \
+  { "SSS", GESTURE_PREV_MODE  },           \
+  { "SSL", GESTURE_POWER_MODE },           \
+}
+
+// ===================================================
+//  GRIP MODES
+//  Fingers outside a mode's mask stay open.
+//  Finger order: thumb, index, middle, ring, little.
+// ===================================================
+enum GripMode { GRIP_POWER, GRIP_TRIPOD, GRIP_PINCH, GRIP_POINT, GRIP_MODE_COUNT };
+
+#define GRIP_MODE_MASKS { 0x1F, 0x07, 0x03, 0x1D }
+#define GRIP_MODE_NAMES { "POWER", "TRIPOD", "PINCH", "POINT" }
+
+// ===================================================
+//  AUTOMATON (built at compile time)
+// ===================================================
+struct GestureAutomaton {
+  int8_t        next[GESTURE_MAX_STATES][GT_COUNT];   // -1: no edge
+  GestureAction accept[GESTURE_MAX_STATES];
+  bool          leaf[GESTURE_MAX_STATES];             // no longer pattern continues here
+  int           states;
+  bool          error;                                // bad token, duplicate or too big
+};
+
+template <int N>
+constexpr GestureAutomaton gestureBuild(const GesturePattern (&patterns)[N]) {
+  GestureAutomaton a{};
+  for (int s = 0; s < GESTURE_MAX_STATES; s++) {
+    for (int t = 0; t < GT_COUNT; t++) a.next[s][t] = -1;
+    a.accept[s] = GESTURE_NONE;
+    a.leaf[s]   = true;
+  }
+  a.states = 1;
+  for (int p = 0; p < N; p++) {
+    int s = 0, len = 0;
+    for (const char *c = patterns[p].tokens; *c; c++, len++) {
+      int t = *c == 'S' ? GT_SHORT : *c == 'L' ? GT_LONG : -1;
+      if (t < 0 || len >= GESTURE_MAX_TOKENS) { a.error = true; return a; }
+      if (a.next[s][t] < 0) {
+        if (a.states == GESTURE_MAX_STATES) { a.error = true; return a; }
+        a.next[s][t] = (int8_t)a.states++;
+      }
+      a.leaf[s] = false;
+      s = a.next[s][t];
+    }
+    if (s == 0 || a.accept[s] != GESTURE_NONE) { a.error = true; return a; }
+    a.accept[s] = patterns[p].action;
+  }
+  return a;
+}
+
+struct GestureStats {
+  uint32_t tokens;
+  uint32_t detections;
+  uint32_t aborted;            // sequences that matched nothing
+  unsigned long lastMs;        // when the last gesture fired
+};
+
+void gestureReset();
+// Feed the debounced muscle state (decision task)
+GestureAction gestureUpdate(bool active, unsigned long now);
+
+// Grip mode the hand closes with; latched at each close
+void        gripModeApply(GestureAction a);
+void        gripModeLatch();
+uint8_t     gripModeMask();
+const char *gripModeName();
+
+const GestureStats &gestureStats();
+void gesturePrint();
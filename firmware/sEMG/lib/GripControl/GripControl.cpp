@@ -0,0 +1,481 @@
+#include "GripControl.h"
+#include "Hal.h"
+
+#include <Actuators.h>
+#include <AdcCal.h>
+#include <Arena.h>
+#include <ConfigStore.h>
+#include <Deadline.h>
+#include <FingerCal.h>
+#include <FlightRecorder.h>
+#include <Gesture.h>
+#include <GripForce.h>
+#include <Pipeline.h>
+#include <Scheduler.h>
+#include <SignalQuality.h>
+#include <Teleplot.h>
+#include <UsageStats.h>
+#include <math.h>
+#include <string.h>
+
+// ===================================================
+//  SIGNAL PROCESSING
+// ===================================================
+GRIP_STATE GripParams gripParams = GRIP_PARAMS_DEFAULT;
+
+GRIP_STATE float rmsValue  = 0;
+
+static inline DspStore &dsp() { return arenaStore<DspStore, ARENA_DSP>(); }
+
+// ===================================================
+//  CALIBRATION — hardcoded from your session data
+// ===================================================
+GRIP_STATE float restMean  = DEFAULT_REST_MEAN;
+GRIP_STATE float restStd   = DEFAULT_REST_STD;
+GRIP_STATE float actMean   = DEFAULT_ACT_MEAN;
+GRIP_STATE float threshold = DEFAULT_THRESHOLD;
+GRIP_STATE bool  calibDone = true;
+GRIP_STATE int   calibPhase = 3;
+GRIP_STATE bool  calibStored = false;
+
+GRIP_STATE bool warmBoot = false;
+GRIP_STATE unsigned long firstDecisionUs = 0;
+
+// ===================================================
+//  MUSCLE STATE
+// ===================================================
+GRIP_STATE bool muscleActive = false;
+GRIP_STATE bool musclePrev   = false;
+GRIP_STATE unsigned long muscleOnTime  = 0;
+GRIP_STATE unsigned long muscleOffTime = 0;
+
+// ===================================================
+//  HAND STATE MACHINE
+// ===================================================
+GRIP_STATE HandState handState = IDLE;
+
+GRIP_STATE int  servoAngle     = SERVO_OPEN;
+
+// ===================================================
+//  HELPER: MOVE ALL SERVOS
+//  `angle` is the grip command; each finger maps it
+//  through its tendon compensation table. Fingers the
+//  grip mode leaves out stay open. One flush per step
+//  (lib/Actuators).
+// ===================================================
+void moveAllFingers(int angle) {
+  uint8_t mask = gripModeMask();
+  for (int i = 0; i < NUM_FINGERS; i++) {
+    actSet(i, fingerAngle(i, (mask >> i) & 1 ? angle : SERVO_OPEN));
+  }
+  actFlush();
+}
+
+// ===================================================
+//  CONFIG: LOAD / SAVE
+// ===================================================
+bool loadCalibration() {
+  CalibRecord rec;
+  if (!configLoad(CALIB_KEY, CALIB_VERSION, &rec, sizeof(rec))) return false;
+  restMean  = rec.restMean;
+  restStd   = rec.restStd;
+  actMean   = rec.actMean;
+  threshold = rec.threshold;
+  return true;
+}
+
+void saveCalibration() {
+  CalibRecord rec = { restMean, restStd, actMean, threshold };
+  configSave(CALIB_KEY, CALIB_VERSION, &rec, sizeof(rec));
+}
+
+bool loadServoState() {
+  ServoRecord rec;
+  if (!configLoad(SERVO_KEY, SERVO_VERSION, &rec, sizeof(rec))) return false;
+  if (rec.angle < SERVO_OPEN || rec.angle > SERVO_CLOSED) return false;
+  servoAngle = rec.angle;
+  return true;
+}
+
+// Settled positions (IDLE / HOLDING) only, to spare flash wear. The
+// NVS commit stalls the loop for a few ms, so the servo task just
+// takes the record; the usage task writes it.
+static GRIP_STATE ServoRecord servoPending;
+static GRIP_STATE bool        servoDirty = false;
+
+void queueServoState() {
+  servoPending.angle = (int16_t)servoAngle;
+  servoDirty = true;
+}
+
+bool saveServoState() {
+  if (!servoDirty) return false;
+  servoDirty = false;
+  configSave(SERVO_KEY, SERVO_VERSION, &servoPending, sizeof(servoPending));
+  return true;
+}
+
+
+// ===================================================
+//  PROCESS EMG
+// ===================================================
+// Volts, high-pass (feeding the quality gate), low-pass, RMS
+// window: lib/Pipeline's EmgPipeline. While the gate is down
+// it holds the last RMS; nobody reads it then.
+void processEMG(int adc) {
+  rmsValue = dsp().emg(adc);
+}
+
+// ===================================================
+//  MUSCLE DEBOUNCE
+// ===================================================
+void updateMuscle(unsigned long now) {
+  bool raw = (rmsValue > threshold);
+  if ( raw && !musclePrev) muscleOnTime  = now;
+  if (!raw &&  musclePrev) muscleOffTime = now;
+  if ( raw && now - muscleOnTime  >= gripParams.confirmMs) muscleActive = true;
+  if (!raw && now - muscleOffTime >= gripParams.releaseMs)  muscleActive = false;
+  musclePrev = raw;
+}
+
+// ===================================================
+//  HAND STATE MACHINE
+//  updateHand() makes the muscle-driven transitions;
+//  stepServos() moves one degree per servo release
+//  and ends the ramps. Entering CLOSING or OPENING
+//  re-phases the servo task so the first step comes
+//  one full step period later.
+// ===================================================
+void updateHand(unsigned long now) {
+  HandState prev = handState;
+
+  switch (handState) {
+
+    case IDLE:
+      // Overload safe state: stay open until the loop keeps up again
+      if (muscleActive && !deadlineSafeState()) {
+        handState = CLOSING;
+        gripModeLatch();
+        forceStartClosing();
+        halPrintln(">> IDLE -> CLOSING");
+      }
+      break;
+
+    case CLOSING:
+      if (!muscleActive) {
+        handState = OPENING;
+        halPrintln(">> CLOSING -> OPENING");
+      }
+      break;
+
+    case HOLDING:
+      if (!muscleActive) {
+        handState = OPENING;
+        halPrintln(">> HOLDING -> OPENING");
+      }
+      // Otherwise hold the angle until the muscle relaxes
+      break;
+
+    case OPENING:
+      break;
+  }
+
+  if (handState != prev) {
+    schedRestart(TASK_SERVO, now);
+    usageTransition(prev, handState, now);
+  }
+}
+
+void stepServos(unsigned long now) {
+  HandState prev = handState;
+
+  if (handState == CLOSING) {
+    if (forceContact()) {
+      // Stop where the fingers met the object
+      handState = HOLDING;
+      forceHoldAt(servoAngle);
+      queueServoState();
+      halPrintf(">> CLOSING -> HOLDING (contact at %d)\n", servoAngle);
+    } else if (servoAngle < SERVO_CLOSED) {
+      servoAngle++;
+      moveAllFingers(servoAngle);
+    } else {
+      handState = HOLDING;
+      forceHoldAt(servoAngle);
+      queueServoState();
+      halPrintln(">> CLOSING -> HOLDING (fully closed)");
+    }
+  } else if (handState == HOLDING) {
+    // Ease off to holding force
+    int d = forceHoldStep(servoAngle);
+    if (d) {
+      servoAngle += d;
+      moveAllFingers(servoAngle);
+    }
+  } else if (handState == OPENING) {
+    if (servoAngle > SERVO_OPEN) {
+      servoAngle--;
+      moveAllFingers(servoAngle);
+    } else {
+      servoAngle = SERVO_OPEN;
+      handState  = IDLE;
+      queueServoState();
+      halPrintln(">> OPENING -> IDLE");
+    }
+  }
+
+  if (handState != prev) usageTransition(prev, handState, now);
+}
+
+// ===================================================
+//  COMMANDS
+// ===================================================
+// A commanded open runs through a quality hold
+static GRIP_STATE bool openForced = false;
+
+void forceOpen(const char *why) {
+  usageForceOpen(handState, halMillis());
+  recorderTrigger(REC_TRIG_FORCE_OPEN);
+  handState  = OPENING;
+  openForced = true;
+  halPrintln(why);
+}
+
+void handleCommand(char cmd) {
+  if (fingerCalCommand(cmd)) return;
+  if (adcSweepCommand(cmd)) return;
+  if (cmd == 'g') fingerCalStart();
+  if (cmd == 'b' && !fingerCalActive()) adcSweepStart();
+  if (cmd == 'o') forceOpen(">> Force open");
+  if (cmd == 't') {
+    halPrintf("RMS:%.4f  Thresh:%.4f  Muscle:%d  Angle:%d  State:%d  Boot:%lu us\n",
+              rmsValue, threshold, muscleActive,
+              servoAngle, (int)handState, firstDecisionUs);
+  }
+  // Manual threshold tuning (persisted)
+  if (cmd == '+') { threshold += 0.005f; saveCalibration(); usageThresholdChange(); halPrintf("Threshold -> %.4f\n", threshold); }
+  if (cmd == '-') { threshold -= 0.005f; saveCalibration(); usageThresholdChange(); halPrintf("Threshold -> %.4f\n", threshold); }
+  if (cmd == 'u') usagePrintSummary(halMillis());
+  if (cmd == 'x') recorderTrigger(REC_TRIG_MANUAL);
+  if (cmd == 'd') recorderStartDump();
+  if (cmd == 'a') adcCalPrint();
+  if (cmd == 's') schedPrint();
+  if (cmd == 'f') telemCycleFields();
+  if (cmd == 'p') telemCycleRate();
+  if (cmd == 'w') telemCycleDecim();
+  if (cmd == 'm') deadlinePrint();
+  if (cmd == 'i') forcePrint();
+  if (cmd == 'e') gesturePrint();
+  if (cmd == 'q') sqPrint();
+  if (cmd == 'v') actPrint();
+  if (cmd == 'h') arenaPrint();
+  if (cmd == 'r') {
+    configErase(CALIB_KEY);
+    configErase(SERVO_KEY);
+    halPrintln(">> Config cleared (defaults on next boot)");
+  }
+}
+
+// ===================================================
+//  TELEPLOT
+// ===================================================
+void sendTelemetry() {
+  telemSend();
+}
+
+// ===================================================
+//  POWER-ON / RESTORE
+// ===================================================
+void gripPowerOn() {
+  GripParams defaults = GRIP_PARAMS_DEFAULT;
+  gripParams = defaults;
+
+  arenaInit();
+  rmsValue = 0;
+
+  restMean  = DEFAULT_REST_MEAN;
+  restStd   = DEFAULT_REST_STD;
+  actMean   = DEFAULT_ACT_MEAN;
+  threshold = DEFAULT_THRESHOLD;
+  calibStored = false;
+
+  warmBoot = false;
+  firstDecisionUs = 0;
+  servoAngle = SERVO_OPEN;
+  servoDirty = false;
+  adcCalIdeal();
+  fingerCalDefaults();
+  forceReset();
+  gestureReset();
+  sqReset();
+  actReset();
+  telemReset();
+  usageReset();
+  recorderReset();
+}
+
+void gripRestore() {
+  // ADC and finger calibration belong to the hardware and survive 'r'
+  adcCalRestore();
+  fingerCalLoad();
+
+  // Restore tuning and last position; a position record means warm
+  // boot. An untuned board has no calibration record and runs on the
+  // defaults, warm or cold.
+  calibStored = loadCalibration();
+  warmBoot = loadServoState();
+
+  // Clean muscle state
+  muscleActive  = false;
+  musclePrev    = false;
+  muscleOnTime  = 0;
+  muscleOffTime = halMillis();
+
+  // Resume from the stored angle; relax back open unless the user flexes
+  handState = (servoAngle > SERVO_OPEN) ? OPENING : IDLE;
+  // Staged here; actBegin() sends them once the outputs are up
+  for (int i = 0; i < NUM_FINGERS; i++) actSet(i, fingerAngle(i, servoAngle));
+
+  usageRestore();
+  gripStartTasks();
+}
+
+// ===================================================
+//  TASKS
+// ===================================================
+static GRIP_STATE bool freshSample = false;   // for the decision task
+static GRIP_STATE bool gated       = false;   // quality gate was down
+static GRIP_STATE int  recordAdc   = -1;      // for the recorder task
+
+static bool taskSample(unsigned long) {
+  int adc;
+  if (!halTakeSample(&adc)) return false;
+  unsigned long arrivalUs;
+  uint32_t seq;
+  halSampleStamp(&arrivalUs, &seq);
+  deadlineSample(arrivalUs, seq);
+  processEMG(adc);
+  adcSweepSample(adc);
+  forceSample(halSampleCurrent());
+  telemObserve(halMillis());
+  freshSample = true;
+  recordAdc   = adc;
+  return true;
+}
+
+static bool taskDecide(unsigned long now) {
+  // Bad electrode signal: keep the last decision, make no new one
+  if (!sqGood()) {
+    gated = true;
+    freshSample = false;
+    return false;
+  }
+  // Back from a gap: pending debounces restart on fresh data
+  if (gated) {
+    gated = false;
+    muscleOnTime = muscleOffTime = now;
+  }
+  updateMuscle(now);
+  // Mode patterns ride on the same edges; they never hold up a close
+  gripModeApply(gestureUpdate(muscleActive, now));
+
+  // First muscle decision on real data: report boot latency once
+  if (freshSample && firstDecisionUs == 0) {
+    firstDecisionUs = halMicros();
+    halPrintf("Boot->first decision: %lu us (%s)\n",
+              firstDecisionUs, warmBoot ? "warm" : "cold");
+  }
+  freshSample = false;
+
+  // Guided finger calibration owns the servos; a bench
+  // sweep's input is no muscle
+  if (!fingerCalActive() && !adcSweepActive()) updateHand(now);
+  return true;
+}
+
+static bool taskServo(unsigned long now) {
+  if (fingerCalActive() || adcSweepActive()) return false;
+  if (handState != OPENING) openForced = false;
+  // Quality gate down: ramps stop where they are; holding
+  // force regulation goes on, it only reads the current sense
+  if (!sqGood() && handState != HOLDING && !openForced) return false;
+  // The release is still the current one while the task runs
+  if (handState == CLOSING || handState == OPENING)
+    deadlineServo(halMicros(), schedStats(TASK_SERVO).nextMs);
+  stepServos(now);
+  return true;
+}
+
+static bool taskRecord(unsigned long) {
+  if (recordAdc < 0) return false;
+  recorderSample(recordAdc, dsp().emg.stage<LowPass<TunedLp>>().y,
+                 (uint8_t)handState | (muscleActive ? REC_STATE_MUSCLE : 0),
+                 halMicros());
+  recordAdc = -1;
+  deadlineSampleDone(halMicros());
+  return true;
+}
+
+static bool taskCommand(unsigned long) {
+  int cmd = halSerialRead();
+  if (cmd < 0) return false;
+  handleCommand((char)cmd);
+  return true;
+}
+
+static bool taskTelemetry(unsigned long) {
+  sendTelemetry();
+  return true;
+}
+
+static bool taskRecorder(unsigned long) {
+  recorderTick();
+  return true;
+}
+
+static bool taskUsage(unsigned long now) {
+  saveServoState();
+  usageTick(now);
+  arenaCheckHeap();
+  return true;
+}
+
+// Budgets are worst cases on the ESP32: the usage task may write flash
+// (NVS commit, sector erase); a servo step may be one I2C burst
+static constexpr SchedTask GRIP_TASKS[] = {
+  // name         period           prio  budget us
+  { "sample",     0,               0,    300,    taskSample    },
+  { "decide",     1,               1,    100,    taskDecide    },
+  { "servo",      SERVO_STEP_MS,   2,    1000,   taskServo     },
+  { "record",     0,               3,    50,     taskRecord    },
+  { "command",    0,               4,    2000,   taskCommand   },
+  { "telemetry",  PLOT_MS,         5,    300,    taskTelemetry },
+  { "recorder",   0,               6,    500,    taskRecorder  },
+  { "usage",      USAGE_TICK_MS,   7,    60000,  taskUsage     },
+};
+
+static_assert(sizeof(GRIP_TASKS) / sizeof(GRIP_TASKS[0]) == GRIP_TASK_COUNT,
+              "task table out of step with GripTask");
+static_assert(schedSorted(GRIP_TASKS), "task table must be sorted by priority");
+
+void gripStartTasks() {
+  freshSample = false;
+  gated       = false;
+  openForced  = false;
+  recordAdc   = -1;
+  schedInit(GRIP_TASKS, GRIP_TASK_COUNT, halMillis());
+  // The step period is a tunable
+  schedSetPeriod(TASK_SERVO, (uint16_t)gripParams.servoStepMs);
+  schedRestart(TASK_SERVO, halMillis());
+  deadlineReset();
+}
+
+// ===================================================
+//  LOOP
+// ===================================================
+void gripLoop() {
+  unsigned long start = halMicros();
+  schedPass();
+  if (deadlinePass(halMicros() - start, halMillis()))
+    forceOpen(">> Overload: force open");
+}
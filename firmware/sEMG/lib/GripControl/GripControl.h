@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===================================================
+//  SERVO
+// ===================================================
+#define NUM_FINGERS      5
+#define NUM_ACTUATORS    (NUM_FINGERS + 2)   // + wrist, thumb rotation
+#define SERVO_OPEN       0
+#define SERVO_CLOSED     130
+#define SERVO_STEP_MS    12
+
+// ===================================================
+//  EMG
+// ===================================================
+#define SAMPLE_RATE_HZ   1000
+#define VREF             3.3f
+#define ADC_MAX          4095.0f
+#define MIDPOINT         1.65f
+#define WINDOW_SIZE      200
+
+// ===================================================
+//  TIMING
+// ===================================================
+#define CONFIRM_MS       300
+#define RELEASE_MS       400
+#define PLOT_MS          20
+#define USAGE_TICK_MS    1000
+
+// ===================================================
+//  FILTERS
+// ===================================================
+#define HP_ALPHA         0.9747f
+#define LP_ALPHA         0.7f
+
+// ===================================================
+//  TUNABLES — start at the defaults above; host
+//  tools (auto-tuner) override them per run
+// ===================================================
+struct GripParams {
+  float         hpAlpha;
+  float         lpAlpha;
+  unsigned long confirmMs;
+  unsigned long releaseMs;
+  unsigned long servoStepMs;
+};
+
+#define GRIP_PARAMS_DEFAULT { HP_ALPHA, LP_ALPHA, CONFIRM_MS, RELEASE_MS, SERVO_STEP_MS }
+
+// ===================================================
+//  CALIBRATION DEFAULTS — hardcoded from session data
+// ===================================================
+#define DEFAULT_REST_MEAN  0.025f
+#define DEFAULT_REST_STD   0.008f
+#define DEFAULT_ACT_MEAN   0.380f
+#define DEFAULT_THRESHOLD  0.055f
+
+// ===================================================
+//  PERSISTENT CONFIG
+// ===================================================
+#define CALIB_KEY        "calib"
+#define CALIB_VERSION    1
+#define SERVO_KEY        "servo"
+#define SERVO_VERSION    2
+
+struct CalibRecord {
+  float restMean;
+  float restStd;
+  float actMean;
+  float threshold;
+};
+
+struct ServoRecord {
+  int16_t angle;
+};
+
+// ===================================================
+//  STATE (defined in GripControl.cpp)
+//  Host tools run one firmware instance per thread.
+// ===================================================
+#ifdef ARDUINO
+#define GRIP_STATE
+#else
+#define GRIP_STATE thread_local
+#endif
+
+enum HandState { IDLE, CLOSING, HOLDING, OPENING };
+
+// Rows of the loop's task table (GripControl.cpp), in priority order
+enum GripTask {
+  TASK_SAMPLE,      // DSP on each 1kHz sample
+  TASK_DECIDE,      // muscle debounce + hand transitions, 1 ms
+  TASK_SERVO,       // one servo step per servoStepMs
+  TASK_RECORD,      // flight recorder, after each sample
+  TASK_COMMAND,
+  TASK_TELEMETRY,   // PLOT_MS
+  TASK_RECORDER,    // snapshot encode / dump
+  TASK_USAGE,       // USAGE_TICK_MS
+  GRIP_TASK_COUNT
+};
+
+#define GRIP_TASK_BIT(t) (1UL << (t))
+
+extern GRIP_STATE GripParams gripParams;
+
+// Filter state and RMS window (lib/Arena, ARENA_DSP): the
+// EmgPipeline that processEMG() runs, defined in lib/Pipeline
+struct DspStore;
+
+extern GRIP_STATE float rmsValue;
+
+extern GRIP_STATE float restMean;
+extern GRIP_STATE float restStd;
+extern GRIP_STATE float actMean;
+extern GRIP_STATE float threshold;
+extern GRIP_STATE bool  calibDone;
+extern GRIP_STATE int   calibPhase;
+extern GRIP_STATE bool  calibStored;
+
+extern GRIP_STATE bool warmBoot;
+extern GRIP_STATE unsigned long firstDecisionUs;
+
+extern GRIP_STATE bool muscleActive;
+extern GRIP_STATE bool musclePrev;
+extern GRIP_STATE unsigned long muscleOnTime;
+extern GRIP_STATE unsigned long muscleOffTime;
+
+extern GRIP_STATE HandState handState;
+extern GRIP_STATE int  servoAngle;
+
+// ===================================================
+//  CONTROL
+// ===================================================
+// Grip command -> every finger in the grip mode, through lib/FingerCal
+void moveAllFingers(int angle);
+
+bool loadCalibration();
+void saveCalibration();
+bool loadServoState();
+// Take the current position for the next saveServoState()
+void queueServoState();
+// Commit a queued position (usage task); false if none was queued
+bool saveServoState();
+
+void  processEMG(int adc);
+void  updateMuscle(unsigned long now);
+void  updateHand(unsigned long now);
+void  stepServos(unsigned long now);
+void  handleCommand(char cmd);
+// Safe state: open the hand now ('o', sustained overload)
+void  forceOpen(const char *why);
+void  sendTelemetry();
+
+// Reset all runtime state to power-on values (host tools reuse
+// one instance per thread across sessions)
+void gripPowerOn();
+// Restore persisted config and reset runtime state (sets warmBoot).
+// configBegin() must have been called first.
+void gripRestore();
+// (Re)start the task table at the current time; gripRestore() does
+// this, call it again after a slow setup
+void gripStartTasks();
+// One pass of the firmware main loop: schedPass() over all tasks
+void gripLoop();
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================
+//  HARDWARE ABSTRACTION
+//
+//  Everything the control code needs from the board.
+//  The firmware implements these in src/main.cpp on
+//  top of Arduino; host tools provide a virtual-time
+//  implementation (see host/sim).
+// ===================================================
+unsigned long halMillis();
+unsigned long halMicros();
+
+// Latest ADC sample from the 1kHz timer; false if none pending
+bool halTakeSample(int *adc);
+// Timer-ISR arrival time and tick number of the sample last taken
+void halSampleStamp(unsigned long *arrivalUs, uint32_t *seq);
+// Servo supply current-sense ADC code read with the sample last taken
+int  halSampleCurrent();
+
+void halServoWrite(int ch, int angle);
+// One I2C write transaction (start, address, data, stop); false on NACK
+bool halI2cWrite(uint8_t addr, const uint8_t *data, size_t len);
+
+// Next command byte, or -1 when nothing is pending
+int  halSerialRead();
+// Bytes the UART can take without blocking
+int  halSerialTxFree();
+// Queue bytes for the UART; callers check halSerialTxFree() first
+void halSerialWrite(const char *data, size_t len);
+void halPrintln(const char *s);
+// Output longer than HAL_PRINTF_MAX - 1 bytes is cut, on every HAL
+#define HAL_PRINTF_MAX  128
+void halPrintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
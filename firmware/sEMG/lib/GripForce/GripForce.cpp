@@ -0,0 +1,119 @@
+#include "GripForce.h"
+
+#include <AdcCal.h>
+#include <Hal.h>
+#include <string.h>
+
+static GRIP_STATE ForceStats stats;
+static GRIP_STATE bool       fitted     = false;
+static GRIP_STATE float      currentA   = 0;
+static GRIP_STATE float      baselineA  = 0;
+static GRIP_STATE bool       learning   = false;
+static GRIP_STATE uint32_t   settle     = 0;    // samples left before the baseline counts
+static GRIP_STATE uint32_t   overFor    = 0;    // samples over the contact level
+static GRIP_STATE uint32_t   stallFor   = 0;
+static GRIP_STATE bool       stalled    = false;
+static GRIP_STATE int        contactAngle = SERVO_CLOSED;
+static GRIP_STATE int        holdCount  = 0;
+
+void forceReset() {
+  memset(&stats, 0, sizeof(stats));
+  fitted    = false;
+  currentA  = 0;
+  baselineA = 0;
+  learning  = false;
+  settle    = 0;
+  overFor   = 0;
+  stallFor  = 0;
+  stalled   = false;
+  contactAngle = SERVO_CLOSED;
+  holdCount = 0;
+}
+
+void forceBegin(bool sensor) { fitted = sensor; }
+
+// ===================================================
+//  ESTIMATOR
+// ===================================================
+void forceSample(int adc) {
+  // No sensor: the pin floats, nothing it reads means anything
+  if (!fitted) return;
+  // adcToVolts() is relative to MIDPOINT; the amplifier output is not
+  float amps = (adcToVolts(adc) + MIDPOINT) / FORCE_V_PER_A;
+  if (amps < 0) amps = 0;
+  currentA += FORCE_ALPHA * (amps - currentA);
+  if (currentA > stats.peakA) stats.peakA = currentA;
+
+  if (learning) {
+    if (settle) {
+      settle--;
+      baselineA = currentA;
+    } else if (currentA < baselineA) {
+      baselineA = currentA;
+    }
+    overFor = (!settle && currentA > baselineA + FORCE_CONTACT_A) ? overFor + 1 : 0;
+  }
+
+  if (currentA <= FORCE_STALL_A) {
+    stallFor = 0;
+    stalled  = false;
+  } else if (++stallFor >= FORCE_STALL_SAMPLES && !stalled) {
+    stalled = true;
+    stats.stalls++;
+    halPrintln(">> Servo stall");
+  }
+}
+
+float forceCurrent() { return currentA; }
+
+// ===================================================
+//  CLOSE / HOLD
+// ===================================================
+void forceStartClosing() {
+  learning = true;
+  settle   = FORCE_SETTLE_SAMPLES;
+  overFor  = 0;
+}
+
+bool forceContact() {
+  if (!fitted || !learning) return false;
+  if (overFor < FORCE_CONFIRM_SAMPLES && !stalled) return false;
+  stats.contacts++;
+  return true;
+}
+
+void forceHoldAt(int angle) {
+  learning     = false;
+  contactAngle = angle;
+  holdCount    = 0;
+}
+
+int forceHoldStep(int angle) {
+  if (!fitted) return 0;
+  // Let the filtered current catch up with the last move
+  if (++holdCount < FORCE_HOLD_STEPS) return 0;
+  holdCount = 0;
+  float over = currentA - baselineA;
+  if (over > FORCE_HOLD_A + FORCE_HOLD_BAND_A && angle > contactAngle - FORCE_BACKOFF_DEG &&
+      angle > SERVO_OPEN)
+    return -1;
+  // Slipping: tighten again, but never past the contact angle
+  if (over < FORCE_HOLD_A - FORCE_HOLD_BAND_A && angle < contactAngle) return 1;
+  return 0;
+}
+
+// ===================================================
+//  REPORT
+// ===================================================
+const ForceStats &forceStats() { return stats; }
+
+void forcePrint() {
+  if (!fitted) {
+    halPrintln("FORCE no current sensor (build with -DFORCE_SENSOR=1)");
+    return;
+  }
+  halPrintf("FORCE current=%.3f A baseline=%.3f A peak=%.3f A contact_angle=%d\n",
+            currentA, baselineA, stats.peakA, contactAngle);
+  halPrintf("FORCE contacts=%lu stalls=%lu\n",
+            (unsigned long)stats.contacts, (unsigned long)stats.stalls);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <GripControl.h>
+
+// ===================================================
+//  GRIP FORCE FROM SERVO CURRENT
+//
+//  The servo supply runs through a shunt and a
+//  current-sense amplifier (FORCE_V_PER_A) into a
+//  second ADC pin, read by the same timer ISR as the
+//  EMG so both arrive as one sample. A servo pushing
+//  against an object draws current roughly in
+//  proportion to the force:
+//
+//  - the current is low-passed per sample. During a
+//    close, the lowest filtered current after the
+//    inrush settles is the free-motion baseline
+//  - contact: the current stays FORCE_CONTACT_A over
+//    that baseline for FORCE_CONFIRM_SAMPLES. Closing
+//    stops there instead of at SERVO_CLOSED
+//  - hold: every FORCE_HOLD_STEPS servo steps the
+//    angle moves one degree toward FORCE_HOLD_A over
+//    baseline. It backs off at most FORCE_BACKOFF_DEG
+//    from the contact angle and never closes past it,
+//    so a parked grip stops drawing stall current
+//  - stall: FORCE_STALL_A for FORCE_STALL_SAMPLES,
+//    reported once per episode
+//
+//  The sensor is optional (FORCE_SENSOR, a build
+//  flag, default off). Without one GPIO35 floats and
+//  reads whatever it picks up, so forceBegin(false)
+//  leaves the estimator idle: contact and stall never
+//  fire, the hold never moves and the hand closes
+//  fully as before. In the Wokwi diagram a
+//  potentiometer on GPIO35 stands in for the
+//  amplifier output. 'i' prints the estimator.
+// ===================================================
+#ifndef FORCE_SENSOR
+#define FORCE_SENSOR 0
+#endif
+
+#define FORCE_V_PER_A          0.2f     // 10 mOhm shunt, 20 V/V amplifier
+#define FORCE_ALPHA            0.025f   // per-sample low-pass, ~40 ms
+#define FORCE_SETTLE_SAMPLES   60       // ignore the start-of-move inrush
+#define FORCE_CONTACT_A        0.40f
+#define FORCE_CONFIRM_SAMPLES  20
+#define FORCE_HOLD_A           0.25f    // target over baseline while holding
+#define FORCE_HOLD_BAND_A      0.10f
+#define FORCE_HOLD_STEPS       4
+#define FORCE_BACKOFF_DEG      20
+#define FORCE_STALL_A          6.0f
+#define FORCE_STALL_SAMPLES    200
+
+struct ForceStats {
+  uint32_t contacts;
+  uint32_t stalls;
+  float    peakA;        // highest filtered current
+};
+
+void  forceReset();
+// Whether the current-sense amplifier is fitted (FORCE_SENSOR)
+void  forceBegin(bool fitted);
+// One current-sense ADC code (sample task)
+void  forceSample(int adc);
+// Filtered servo supply current, amps
+float forceCurrent();
+
+// A close starts: relearn the free-motion baseline
+void  forceStartClosing();
+// Confirmed contact (or stall) since forceStartClosing()
+bool  forceContact();
+// Contact at `angle`: hold regulation starts from there
+void  forceHoldAt(int angle);
+// Degrees to move the held grip this servo step (-1, 0, +1)
+int   forceHoldStep(int angle);
+
+const ForceStats &forceStats();
+void  forcePrint();
@@ -0,0 +1,28 @@
+#include "Pca9685.h"
+
+#include <Hal.h>
+
+// PRE_SCALE can only be written while the oscillator sleeps
+bool pca9685Begin(uint8_t addr) {
+  const uint8_t sleep[]    = { PCA9685_MODE1, PCA9685_MODE1_SLEEP | PCA9685_MODE1_AI };
+  const uint8_t prescale[] = { PCA9685_PRE_SCALE, PCA9685_PRESCALE };
+  const uint8_t wake[]     = { PCA9685_MODE1, PCA9685_MODE1_AI };
+  return halI2cWrite(addr, sleep, sizeof(sleep)) &&
+         halI2cWrite(addr, prescale, sizeof(prescale)) &&
+         halI2cWrite(addr, wake, sizeof(wake));
+}
+
+size_t pca9685Write(uint8_t addr, const uint16_t *pulseUs, int lo, int hi) {
+  if (lo < 0 || hi >= PCA9685_CHANNELS || lo > hi) return 0;
+  uint8_t buf[PCA9685_BURST_MAX];
+  size_t  n = 0;
+  buf[n++] = (uint8_t)(PCA9685_LED0_ON_L + 4 * lo);
+  for (int ch = lo; ch <= hi; ch++) {
+    uint16_t off = pca9685Counts(pulseUs[ch]);
+    buf[n++] = 0;
+    buf[n++] = 0;
+    buf[n++] = (uint8_t)(off & 0xFF);
+    buf[n++] = (uint8_t)(off >> 8);
+  }
+  return halI2cWrite(addr, buf, n) ? n : 0;
+}
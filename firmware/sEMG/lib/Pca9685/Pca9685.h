@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===================================================
+//  PCA9685 I2C PWM EXPANDER
+//
+//  16 channels of 12-bit PWM behind one I2C address,
+//  clocked from a 25 MHz oscillator divided by
+//  PRE_SCALE + 1. With MODE1.AI set the register
+//  pointer walks on by itself, so a whole span of
+//  channels goes out in one write transaction:
+//
+//    LEDn_ON_L, then ON_L ON_H OFF_L OFF_H per channel
+//
+//  ON is always 0; OFF is the pulse width in counts.
+//  Only the bytes are built here; the bus is Hal.h's
+//  halI2cWrite().
+// ===================================================
+#define PCA9685_ADDR         0x40
+#define PCA9685_CHANNELS     16
+#define PCA9685_OSC_HZ       25000000UL
+#define PCA9685_PRESCALE     121          // 25 MHz / (4096 * 122) = 50.03 Hz
+
+#define PCA9685_MODE1        0x00
+#define PCA9685_LED0_ON_L    0x06
+#define PCA9685_PRE_SCALE    0xFE
+#define PCA9685_MODE1_AI     0x20
+#define PCA9685_MODE1_SLEEP  0x10
+
+// Register byte plus four per channel
+#define PCA9685_BURST_MAX    (1 + 4 * PCA9685_CHANNELS)
+
+#define PCA9685_TICK_DIV     (PCA9685_PRESCALE + 1)
+#define PCA9685_TICK_MUL     (PCA9685_OSC_HZ / 1000000UL)
+
+// Pulse width <-> counts, rounded (one count is 4.88 us)
+constexpr uint16_t pca9685Counts(uint32_t us) {
+  return (uint16_t)((us * PCA9685_TICK_MUL + PCA9685_TICK_DIV / 2) / PCA9685_TICK_DIV);
+}
+constexpr uint32_t pca9685Us(uint16_t counts) {
+  return ((uint32_t)counts * PCA9685_TICK_DIV + PCA9685_TICK_MUL / 2) / PCA9685_TICK_MUL;
+}
+
+// Sleep, set the 50 Hz prescaler, wake with auto-increment
+bool pca9685Begin(uint8_t addr);
+
+// Channels lo..hi (inclusive) from pulseUs[lo..hi] in one
+// transaction; returns the bytes on the wire, 0 on a NACK
+size_t pca9685Write(uint8_t addr, const uint16_t *pulseUs, int lo, int hi);
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <tuple>
+
+#include <AdcCal.h>
+#include <GripControl.h>
+#include <SignalQuality.h>
+
+// ===================================================
+//  COMPILE-TIME SIGNAL PIPELINE
+//
+//  A pipeline is a type list of stages:
+//
+//    Pipeline<AdcVolts, HighPass<Coef<9747>>,
+//             LowPass<Coef<7000>>, RmsWindow<200>>
+//
+//  Each stage is a plain struct whose operator()
+//  takes the previous stage's output. Parameters are
+//  template arguments, so the whole chain is inlined
+//  into one loop with the constants folded in. There
+//  is no virtual dispatch and no branching on the
+//  configuration. An experiment is a one-line change
+//  to the type.
+//
+//  Coefficients are types with a static value():
+//  Coef<E4> is a constant (value / 10000), TunedHp
+//  and TunedLp read gripParams so the auto-tuner can
+//  still sweep them.
+//
+//  processEMG() runs EmgPipeline, held in DspStore.
+//  host/pipebench keeps the original hand-written
+//  chain as the reference, checks processEMG() against
+//  it bit for bit and times the experiments.
+// ===================================================
+template <class... Stages>
+class Pipeline {
+public:
+  template <class In>
+  inline auto operator()(In x) { return run<0>(x); }
+
+  // One fused loop over a block
+  template <class In, class Out>
+  void block(const In *in, size_t n, Out *out) {
+    for (size_t i = 0; i < n; i++) out[i] = run<0>(in[i]);
+  }
+
+  void reset() { stages = std::tuple<Stages...>(); }
+
+  // Stage state, e.g. stage<LowPass<TunedLp>>().y
+  template <class S>
+  S &stage() { return std::get<S>(stages); }
+
+private:
+  template <size_t I, class T>
+  inline auto run(T x) {
+    if constexpr (I == sizeof...(Stages)) return x;
+    else return run<I + 1>(std::get<I>(stages)(x));
+  }
+
+  std::tuple<Stages...> stages;
+};
+
+// ===================================================
+//  COEFFICIENTS
+// ===================================================
+template <int E4>
+struct Coef {
+  static constexpr float value() { return E4 / 10000.0f; }
+};
+
+struct TunedHp {
+  static float value() { return gripParams.hpAlpha; }
+};
+
+struct TunedLp {
+  static float value() { return gripParams.lpAlpha; }
+};
+
+// ===================================================
+//  STAGES
+// ===================================================
+// ADC code -> volts about MIDPOINT (calibrated table)
+struct AdcVolts {
+  inline float operator()(int adc) const { return adcToVolts(adc); }
+};
+
+template <class Alpha>
+struct HighPass {
+  float x = 0, y = 0;
+  inline float operator()(float in) {
+    y = Alpha::value() * (y + in - x);
+    x = in;
+    return y;
+  }
+};
+
+template <class Alpha>
+struct LowPass {
+  float y = 0;
+  inline float operator()(float in) {
+    const float a = Alpha::value();
+    y = a * y + (1.0f - a) * in;
+    return y;
+  }
+};
+
+// Signal-quality tap (lib/SignalQuality). QualityVolts keeps the
+// raw code next to the volts; QualityHighPass filters like HighPass
+// and feeds sqSample() on the side.
+struct SqIn {
+  int   adc;
+  float v;
+};
+
+struct QualityVolts {
+  inline SqIn operator()(int adc) const { return { adc, adcToVolts(adc) }; }
+};
+
+template <class Alpha>
+struct QualityHighPass {
+  HighPass<Alpha> hp;
+  inline float operator()(SqIn in) {
+    float y = hp(in.v);
+    sqSample(in.adc, in.v, y);
+    return y;
+  }
+};
+
+// Full-wave rectifier, for envelope chains (Rectify, LowPass)
+struct Rectify {
+  inline float operator()(float in) const { return fabsf(in); }
+};
+
+// RMS over the last N samples, recomputed every sample in index
+// order exactly like computeRMS(). Gated keeps the last value while
+// the quality gate is down, as processEMG() does.
+template <int N, bool Gated = false>
+struct RmsWindow {
+  float buf[N] = {0};
+  int   idx = 0;
+  float rms = 0;
+  inline float operator()(float in) {
+    buf[idx] = in;
+    idx = (idx + 1) % N;
+    if (Gated && !sqGood()) return rms;
+    float sum = 0;
+    for (int i = 0; i < N; i++) sum += buf[i] * buf[i];
+    rms = sqrtf(sum / N);
+    return rms;
+  }
+};
+
+// RMS over the last N samples in O(1): a running sum of squares,
+// re-summed once per wrap so float error cannot build up
+template <int N>
+struct RunningRms {
+  float buf[N] = {0};
+  float sum = 0;
+  int   idx = 0;
+  inline float operator()(float in) {
+    float sq = in * in;
+    sum += sq - buf[idx];
+    buf[idx] = sq;
+    if (++idx == N) {
+      idx = 0;
+      sum = 0;
+      for (int i = 0; i < N; i++) sum += buf[i];
+    }
+    return sqrtf((sum > 0 ? sum : 0) / N);
+  }
+};
+
+// Mean absolute value over the last N samples, O(1)
+template <int N>
+struct MeanAbs {
+  float buf[N] = {0};
+  float sum = 0;
+  int   idx = 0;
+  inline float operator()(float in) {
+    float a = fabsf(in);
+    sum += a - buf[idx];
+    buf[idx] = a;
+    if (++idx == N) {
+      idx = 0;
+      sum = 0;
+      for (int i = 0; i < N; i++) sum += buf[i];
+    }
+    return (sum > 0 ? sum : 0) / N;
+  }
+};
+
+// Raw detector: feature above a runtime level (the calibrated
+// threshold); debouncing stays in updateMuscle()
+struct Above {
+  float level = DEFAULT_THRESHOLD;
+  inline bool operator()(float in) const { return in > level; }
+};
+
+// The firmware's processEMG() chain
+typedef Pipeline<QualityVolts, QualityHighPass<TunedHp>, LowPass<TunedLp>,
+                 RmsWindow<WINDOW_SIZE, true>> EmgPipeline;
+
+// lib/Arena, ARENA_DSP
+struct DspStore {
+  EmgPipeline emg;
+};
@@ -0,0 +1,85 @@
+#include "Scheduler.h"
+
+#include <Hal.h>
+#include <string.h>
+
+static GRIP_STATE const SchedTask *table = nullptr;
+static GRIP_STATE int              count = 0;
+
+static inline SchedStats *stats() { return arenaStore<SchedStore, ARENA_SCHED>().stats; }
+
+// ===================================================
+//  SETUP
+// ===================================================
+void schedInit(const SchedTask *tasks, int n, unsigned long nowMs) {
+  table = tasks;
+  count = n < SCHED_MAX_TASKS ? n : SCHED_MAX_TASKS;
+  SchedStats *st = stats();
+  memset(st, 0, sizeof(SchedStore));
+  for (int i = 0; i < count; i++) {
+    st[i].periodMs = tasks[i].periodMs;
+    st[i].nextMs   = nowMs;
+  }
+}
+
+void schedRestart(int id, unsigned long nowMs) {
+  SchedStats &s = stats()[id];
+  s.nextMs = nowMs + s.periodMs;
+}
+
+void schedSetPeriod(int id, uint16_t periodMs) {
+  // An event task stays an event task
+  SchedStats &s = stats()[id];
+  if (s.periodMs && periodMs) s.periodMs = periodMs;
+}
+
+const SchedStats &schedStats(int id) { return stats()[id]; }
+
+// ===================================================
+//  PASS
+// ===================================================
+void schedPass(uint32_t mask) {
+  unsigned long now = halMillis();
+
+  for (int i = 0; i < count; i++) {
+    if (!(mask & (1UL << i))) continue;
+    const SchedTask &t = table[i];
+    SchedStats      &s = stats()[i];
+    if (s.periodMs && (long)(now - s.nextMs) < 0) continue;
+
+    unsigned long t0 = halMicros();
+    bool worked = t.run(now);
+    unsigned long us = halMicros() - t0;
+
+    // Releases stay on the period grid; a task that restarted
+    // itself during the run keeps its new phase
+    if (s.periodMs && (long)(now - s.nextMs) >= 0) {
+      s.nextMs += s.periodMs;
+      if ((long)(now - s.nextMs) >= 0) {
+        unsigned long behind = (now - s.nextMs) / s.periodMs + 1;
+        s.skipped += behind;
+        s.nextMs  += behind * s.periodMs;
+      }
+    }
+    if (!worked) continue;
+
+    s.runs++;
+    s.totalUs += us;
+    if (us > s.maxUs) s.maxUs = us;
+    if (us > t.budgetUs) s.overruns++;
+  }
+}
+
+// ===================================================
+//  REPORT
+// ===================================================
+void schedPrint() {
+  for (int i = 0; i < count; i++) {
+    const SchedStats &s = stats()[i];
+    halPrintf("SCHED %s p=%u pr=%u b=%u runs=%lu over=%lu skip=%lu max=%lu avg=%lu\n",
+              table[i].name, s.periodMs, table[i].priority, table[i].budgetUs,
+              (unsigned long)s.runs, (unsigned long)s.overruns, (unsigned long)s.skipped,
+              (unsigned long)s.maxUs,
+              (unsigned long)(s.runs ? s.totalUs / s.runs : 0));
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+
+// ===================================================
+//  COOPERATIVE SCHEDULER
+//
+//  Tasks are declared once in a constexpr table,
+//  sorted by priority (0 = most urgent; checked at
+//  compile time with schedSorted). Each pass of the
+//  main loop runs every due task, in table order, to
+//  completion:
+//
+//  - periodic tasks (periodMs > 0) are released every
+//    periodMs. A release that falls a whole period
+//    behind is counted as skipped instead of being run
+//    twice
+//  - event tasks (periodMs == 0) are polled on every
+//    pass and return whether they had any work
+//
+//  Each run that did work is timed against the task's
+//  budget. Runs over budget count as overruns.
+// ===================================================
+#define SCHED_MAX_TASKS  12
+#define SCHED_ALL        0xFFFFFFFFUL
+
+// Returns false when an event task found nothing to do
+typedef bool (*SchedFn)(unsigned long nowMs);
+
+struct SchedTask {
+  const char *name;
+  uint16_t    periodMs;    // 0 = event task, polled every pass
+  uint8_t     priority;
+  uint16_t    budgetUs;    // per run
+  SchedFn     run;
+};
+
+struct SchedStats {
+  unsigned long nextMs;    // next release (periodic tasks)
+  uint16_t periodMs;       // table value unless changed at runtime
+  uint32_t runs;
+  uint32_t overruns;       // runs over budgetUs
+  uint32_t skipped;        // releases missed by a whole period
+  uint32_t maxUs;
+  uint64_t totalUs;
+};
+
+// Stats rows, by task id (lib/Arena, ARENA_SCHED)
+struct SchedStore {
+  SchedStats stats[SCHED_MAX_TASKS];
+};
+
+template <size_t N>
+constexpr bool schedSorted(const SchedTask (&tasks)[N]) {
+  for (size_t i = 1; i < N; i++)
+    if (tasks[i].priority < tasks[i - 1].priority) return false;
+  return N <= SCHED_MAX_TASKS;
+}
+
+// Start the table; every periodic task is first released at nowMs
+void schedInit(const SchedTask *tasks, int n, unsigned long nowMs);
+// One loop pass over the tasks whose bit is set in `mask`
+void schedPass(uint32_t mask = SCHED_ALL);
+// Re-phase a periodic task: next release one period after nowMs
+void schedRestart(int id, unsigned long nowMs);
+void schedSetPeriod(int id, uint16_t periodMs);
+const SchedStats &schedStats(int id);
+// One line per task on the UART
+void schedPrint();
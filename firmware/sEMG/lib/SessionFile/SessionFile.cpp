@@ -0,0 +1,98 @@
+#include "SessionFile.h"
+
+#include <string.h>
+
+// ===================================================
+//  WRITER
+// ===================================================
+bool SessionWriter::open(const char *path, uint32_t sampleRateHz, uint64_t seed) {
+  close();
+  f = fopen(path, "wb");
+  if (!f) return false;
+  memcpy(hdr.magic, SESSION_MAGIC, sizeof(hdr.magic));
+  hdr.version      = SESSION_VERSION;
+  hdr.sampleRateHz = sampleRateHz;
+  hdr.samples      = 0;
+  hdr.seed         = seed;
+  return fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+}
+
+bool SessionWriter::write(const uint16_t *codes, size_t n) {
+  if (!f) return false;
+  if (fwrite(codes, sizeof(uint16_t), n, f) != n) return false;
+  hdr.samples += n;
+  return true;
+}
+
+bool SessionWriter::close() {
+  if (!f) return true;
+  bool ok = fseek(f, 0, SEEK_SET) == 0 && fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+  ok = (fclose(f) == 0) && ok;
+  f = nullptr;
+  return ok;
+}
+
+// ===================================================
+//  READER
+// ===================================================
+bool SessionReader::open(const char *path) {
+  close();
+  f = fopen(path, "rb");
+  if (!f) return false;
+  if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+      memcmp(hdr.magic, SESSION_MAGIC, sizeof(hdr.magic)) != 0 ||
+      hdr.version != SESSION_VERSION) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+size_t SessionReader::read(uint16_t *codes, size_t n) {
+  return f ? fread(codes, sizeof(uint16_t), n, f) : 0;
+}
+
+void SessionReader::close() {
+  if (f) fclose(f);
+  f = nullptr;
+}
+
+// ===================================================
+//  LABELS
+// ===================================================
+static void labelPath(const char *sessionPath, char *out, size_t len) {
+  snprintf(out, len, "%s.labels.csv", sessionPath);
+}
+
+bool sessionWriteLabels(const char *sessionPath, const SessionLabel *labels, size_t n) {
+  char path[512];
+  labelPath(sessionPath, path, sizeof(path));
+  FILE *lf = fopen(path, "w");
+  if (!lf) return false;
+  fprintf(lf, "onset,offset\n");
+  for (size_t i = 0; i < n; i++)
+    fprintf(lf, "%llu,%llu\n", (unsigned long long)labels[i].onset,
+            (unsigned long long)labels[i].offset);
+  return fclose(lf) == 0;
+}
+
+long sessionReadLabels(const char *sessionPath, SessionLabel *labels, size_t max) {
+  char path[512];
+  labelPath(sessionPath, path, sizeof(path));
+  FILE *lf = fopen(path, "r");
+  if (!lf) return -1;
+  char line[96];
+  size_t n = 0;
+  while (fgets(line, sizeof(line), lf)) {
+    unsigned long long on, off;
+    if (sscanf(line, "%llu,%llu", &on, &off) != 2) continue;
+    // Counted past max, so the caller sees what it missed
+    if (n < max) {
+      labels[n].onset  = on;
+      labels[n].offset = off;
+    }
+    n++;
+  }
+  fclose(lf);
+  return (long)n;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+// ===================================================
+//  SESSION FILE (host only)
+//
+//  Raw recording of the EMG ADC stream:
+//    SessionHeader | uint16 ADC codes (little endian)
+//  Ground-truth contraction labels, when known, live
+//  in a sidecar "<file>.labels.csv" (onset,offset).
+// ===================================================
+#define SESSION_MAGIC   "SEMGSES1"
+#define SESSION_VERSION 1
+
+struct SessionHeader {
+  char     magic[8];
+  uint32_t version;
+  uint32_t sampleRateHz;
+  uint64_t samples;
+  uint64_t seed;        // 0 for real recordings
+};
+
+struct SessionLabel {
+  uint64_t onset;       // first sample of the contraction ramp
+  uint64_t offset;      // first rest sample after it
+};
+
+class SessionWriter {
+public:
+  ~SessionWriter() { close(); }
+  bool open(const char *path, uint32_t sampleRateHz, uint64_t seed = 0);
+  bool write(const uint16_t *codes, size_t n);
+  // Patches the sample count into the header
+  bool close();
+
+private:
+  FILE         *f = nullptr;
+  SessionHeader hdr;
+};
+
+class SessionReader {
+public:
+  ~SessionReader() { close(); }
+  bool   open(const char *path);
+  // Returns the number of codes read; 0 at end of file
+  size_t read(uint16_t *codes, size_t n);
+  void   close();
+  const SessionHeader &header() const { return hdr; }
+
+private:
+  FILE         *f = nullptr;
+  SessionHeader hdr;
+};
+
+bool sessionWriteLabels(const char *sessionPath, const SessionLabel *labels, size_t n);
+// Stores the first max labels. Returns how many the file holds (more
+// than max if some did not fit), or -1 if there is no label file
+long sessionReadLabels(const char *sessionPath, SessionLabel *labels, size_t max);
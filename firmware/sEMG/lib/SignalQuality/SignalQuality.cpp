@@ -0,0 +1,71 @@
+#include "SignalQuality.h"
+
+#include <Hal.h>
+#include <math.h>
+#include <string.h>
+
+static const char *FLAG_NAMES[SQ_FLAG_COUNT] = { "OK", "CLIPPING", "FLAT", "ARTIFACT" };
+
+GRIP_STATE bool sqOk = true;
+
+static GRIP_STATE SqStats stats;
+static GRIP_STATE SqFlag  last = SQ_GOOD;
+static GRIP_STATE int     goodRun = 0;
+
+void sqReset() {
+  memset(&sqAcc(), 0, sizeof(SqAcc));
+  memset(&stats, 0, sizeof(stats));
+  sqOk    = true;
+  last    = SQ_GOOD;
+  goodRun = 0;
+}
+
+// ===================================================
+//  VERDICT
+// ===================================================
+static SqFlag classify(const SqAcc &a) {
+  const float n = (float)a.n;
+  float mean = a.sum / n;
+  if (a.clips > SQ_CLIP_MAX && fabsf(a.ref + mean) > SQ_CLIP_OFFSET) return SQ_CLIPPING;
+  if (a.sumSq / n - mean * mean < SQ_FLAT_VAR) return SQ_FLAT;
+  float lowMean = a.lowSum / n;
+  float lowVar  = a.lowSq / n - lowMean * lowMean;
+  if (lowVar > SQ_OOB_MIN_VAR && lowVar > SQ_OOB_RATIO * a.band / n) return SQ_ARTIFACT;
+  return SQ_GOOD;
+}
+
+void sqWindow() {
+  SqAcc &a = sqAcc();
+  SqFlag f = classify(a);
+  float mean = a.ref + a.sum / a.n;
+  memset(&a, 0, sizeof(a));
+  a.ref = mean;
+  stats.windows++;
+  stats.bad[f]++;
+  last = f;
+
+  if (f != SQ_GOOD) {
+    goodRun = 0;
+    if (sqOk) {
+      sqOk = false;
+      stats.drops++;
+      halPrintf(">> Signal %s: hold\n", FLAG_NAMES[f]);
+    }
+  } else if (!sqOk && ++goodRun >= SQ_RECOVER_WINDOWS) {
+    sqOk = true;
+    halPrintln(">> Signal OK");
+  }
+}
+
+// ===================================================
+//  REPORT
+// ===================================================
+SqFlag         sqLastFlag() { return last; }
+const SqStats &sqStats()    { return stats; }
+
+void sqPrint() {
+  halPrintf("SIGNAL %s windows=%lu clipping=%lu flat=%lu artifact=%lu drops=%lu\n",
+            sqOk ? "OK" : FLAG_NAMES[last], (unsigned long)stats.windows,
+            (unsigned long)stats.bad[SQ_CLIPPING], (unsigned long)stats.bad[SQ_FLAT],
+            (unsigned long)stats.bad[SQ_ARTIFACT], (unsigned long)stats.drops);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+
+// ===================================================
+//  SIGNAL-QUALITY GATE
+//
+//  processEMG() feeds every sample here before it is
+//  filtered further. Per sample this is a range
+//  compare and five multiply-adds; the verdict is
+//  made once per SQ_WINDOW samples:
+//
+//  - CLIPPING: more than SQ_CLIP_MAX codes at the
+//    rails and the window mean over SQ_CLIP_OFFSET
+//    from MIDPOINT: the front end is pinned (lead
+//    off, saturated amplifier). A contraction strong
+//    enough to clip swings to both rails about
+//    MIDPOINT and still counts as signal.
+//  - FLAT: input variance under SQ_FLAT_VAR, i.e. no
+//    noise at all (electrode off, amplifier parked)
+//  - ARTIFACT: what the high-pass removes (below
+//    ~4 Hz: cable sway, electrode pressure) carries
+//    more variance than the EMG band, and more than
+//    SQ_OOB_MIN_VAR
+//
+//  One bad window drops the gate at once;
+//  SQ_RECOVER_WINDOWS good ones in a row raise it
+//  again. While it is down, the decision logic is
+//  frozen: no muscle or gesture updates, no ramps, and
+//  processEMG() skips the RMS window. The hand holds
+//  where it is until the signal comes back; only a
+//  commanded open ('o', overload) still moves it. 'q'
+//  prints the counters.
+// ===================================================
+#define SQ_WINDOW           200
+#define SQ_CLIP_LO          16
+#define SQ_CLIP_HI          (4095 - 16)
+#define SQ_CLIP_MAX         10          // per window (5%)
+#define SQ_CLIP_OFFSET      1.2f        // V from MIDPOINT, 0.45 V short of a rail
+#define SQ_FLAT_VAR         1e-6f       // V^2: ~1 mV rms, about 1 LSB
+#define SQ_OOB_MIN_VAR      4e-3f       // V^2: ~60 mV rms below the EMG band
+#define SQ_OOB_RATIO        1.0f
+#define SQ_RECOVER_WINDOWS  1
+
+enum SqFlag { SQ_GOOD, SQ_CLIPPING, SQ_FLAT, SQ_ARTIFACT, SQ_FLAG_COUNT };
+
+// Window accumulators. Sums are taken about the last window's
+// mean so a rail-stuck input cannot cancel out.
+struct SqAcc {
+  uint16_t n;
+  uint16_t clips;
+  float    ref;                 // last window's mean
+  float    sum, sumSq;          // input
+  float    lowSum, lowSq;       // input - high-pass
+  float    band;                // high-pass energy
+};
+
+struct SqStats {
+  uint32_t windows;
+  uint32_t bad[SQ_FLAG_COUNT];  // windows per verdict
+  uint32_t drops;               // times the gate went down
+};
+
+// Accumulators in lib/Arena (ARENA_QUALITY); sqOk in SignalQuality.cpp
+inline SqAcc &sqAcc() { return arenaStore<SqAcc, ARENA_QUALITY>(); }
+extern GRIP_STATE bool sqOk;
+
+// End of window: verdict and gate update
+void sqWindow();
+
+// One sample: raw code, calibrated volts and high-pass output
+inline void sqSample(int adc, float v, float hp) {
+  SqAcc &a = sqAcc();
+  a.clips += (unsigned)(adc - SQ_CLIP_LO) > (unsigned)(SQ_CLIP_HI - SQ_CLIP_LO);
+  float d   = v - a.ref;
+  float low = d - hp;
+  a.sum    += d;
+  a.sumSq  += d * d;
+  a.lowSum += low;
+  a.lowSq  += low * low;
+  a.band   += hp * hp;
+  if (++a.n == SQ_WINDOW) sqWindow();
+}
+
+inline bool sqGood() { return sqOk; }
+
+void          sqReset();
+SqFlag        sqLastFlag();
+const SqStats &sqStats();
+void          sqPrint();
@@ -0,0 +1,283 @@
+#include "SimHal.h"
+
+#include <Actuators.h>
+#include <GripControl.h>
+#include <Hal.h>
+#include <Pca9685.h>
+
+#include <deque>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_TICK_US  (1000000UL / SAMPLE_RATE_HZ)
+#define SIM_I2C_HZ   400000UL
+#define PCA_MODE1_POWER_ON    0x11      // SLEEP | ALLCALL
+#define PCA_PRESCALE_POWER_ON 0x1E
+
+struct SimKey {
+  unsigned long ms;
+  char c;
+};
+
+static thread_local unsigned long nowUs        = 0;
+static thread_local unsigned long loopCostUs   = 20;
+static thread_local unsigned long nextTickUs   = 0;
+static thread_local unsigned long tickIndex    = 0;
+static thread_local unsigned long passes       = 0;
+static thread_local unsigned long missed       = 0;
+static thread_local bool          pending      = false;
+static thread_local int           pendingAdc   = 0;
+static thread_local int           pendingCurrent = 0;
+static thread_local int           takenCurrent = 0;
+static thread_local unsigned long pendingUs    = 0;
+static thread_local unsigned long takenUs      = 0;
+static thread_local unsigned long takenTick    = 0;
+static thread_local bool          keepTelemetry = false;
+static thread_local bool          muted = false;
+static thread_local bool          tracing = true;
+
+static thread_local SimAdcSource adcSource = nullptr;
+static thread_local void        *adcCtx    = nullptr;
+static thread_local SimCurrentSource currentSource = nullptr;
+static thread_local void        *currentCtx = nullptr;
+static thread_local SimUartSink  uartSink  = nullptr;
+static thread_local void        *uartCtx   = nullptr;
+
+static thread_local unsigned long i2cHz = SIM_I2C_HZ;
+static thread_local uint8_t       pcaRegs[256];
+
+static thread_local int                        servos[NUM_ACTUATORS];
+static thread_local std::deque<SimKey>         keys;
+static thread_local std::string                lineBuf;
+static thread_local std::vector<SimServoEvent> servoTrace;
+static thread_local std::vector<SimStateEvent> stateTrace;
+static thread_local int                        tracedState = -1;   // last state in stateTrace
+static thread_local std::vector<SimRmsEvent>   rmsTrace;
+static thread_local std::vector<SimLogLine>    logLines;
+static thread_local std::vector<SimI2cEvent>   i2cTrace;
+
+// ===================================================
+//  CONTROL
+// ===================================================
+void simReset(unsigned long startUs) {
+  nowUs      = startUs;
+  nextTickUs = startUs - startUs % SIM_TICK_US + SIM_TICK_US;
+  tickIndex  = nextTickUs / SIM_TICK_US;
+  passes     = 0;
+  missed     = 0;
+  pending    = false;
+  takenCurrent = 0;
+  for (int i = 0; i < NUM_ACTUATORS; i++) servos[i] = SERVO_OPEN;
+  memset(pcaRegs, 0, sizeof(pcaRegs));
+  pcaRegs[PCA9685_MODE1]     = PCA_MODE1_POWER_ON;
+  pcaRegs[PCA9685_PRE_SCALE] = PCA_PRESCALE_POWER_ON;
+  keys.clear();
+  lineBuf.clear();
+  servoTrace.clear();
+  stateTrace.clear();
+  tracedState = -1;
+  rmsTrace.clear();
+  logLines.clear();
+  i2cTrace.clear();
+}
+
+void simSetAdcSource(SimAdcSource src, void *ctx) { adcSource = src; adcCtx = ctx; }
+void simSetCurrentSource(SimCurrentSource src, void *ctx) { currentSource = src; currentCtx = ctx; }
+void simSetUartSink(SimUartSink sink, void *ctx)  { uartSink = sink; uartCtx = ctx; }
+void simSetLoopCostUs(unsigned long us)           { loopCostUs = us; }
+void simCaptureTelemetry(bool on)                 { keepTelemetry = on; }
+void simMuteUart(bool on)                         { muted = on; }
+void simTraceServos(bool on)                      { tracing = on; }
+void simSetI2cHz(unsigned long hz)                { i2cHz = hz; }
+
+void simClearTraces() {
+  servoTrace.clear();
+  stateTrace.clear();
+  tracedState = -1;
+  rmsTrace.clear();
+  logLines.clear();
+  i2cTrace.clear();
+}
+
+void simPushKey(unsigned long atMs, char c) {
+  SimKey k = { atMs, c };
+  auto it = keys.begin();
+  while (it != keys.end() && it->ms <= atMs) ++it;
+  keys.insert(it, k);
+}
+
+// Latch the most recent timer tick at or before now
+static void latchSamples() {
+  while (nextTickUs <= nowUs) {
+    if (pending) missed++;
+    pendingAdc = adcSource ? adcSource(tickIndex, adcCtx) : (int)(ADC_MAX / 2);
+    pendingCurrent = currentSource ? currentSource(tickIndex, servos, currentCtx) : 0;
+    pendingUs  = nextTickUs;
+    pending    = true;
+    tickIndex++;
+    nextTickUs += SIM_TICK_US;
+  }
+}
+
+static unsigned long nextWakeUs() {
+  unsigned long wake   = nextTickUs;
+  unsigned long nextMs = (nowUs / 1000 + 1) * 1000;
+  if (nextMs < wake) wake = nextMs;
+  if (!keys.empty() && keys.front().ms * 1000 < wake) wake = keys.front().ms * 1000;
+  return wake;
+}
+
+void simRunUntilMs(unsigned long ms) {
+  unsigned long endUs = ms * 1000;
+  // Kept across calls: a state set between runs (reboot) is traced
+  // on the next pass
+  if (tracedState < 0) tracedState = (int)handState;
+  while (nowUs < endUs) {
+    latchSamples();
+    gripLoop();
+    passes++;
+    if ((int)handState != tracedState) {
+      tracedState = (int)handState;
+      SimStateEvent e = { nowUs / 1000, tracedState };
+      stateTrace.push_back(e);
+    }
+    if (tracing && (rmsTrace.empty() || rmsTrace.back().rms != rmsValue)) {
+      SimRmsEvent e = { nowUs / 1000, rmsValue };
+      rmsTrace.push_back(e);
+    }
+
+    // Idle passes only repeat the same decisions: skip to the next event
+    unsigned long after = nowUs + loopCostUs;
+    unsigned long wake  = pending ? after : nextWakeUs();
+    nowUs = (wake > after) ? wake : after;
+  }
+}
+
+void simSetNowUs(unsigned long us) { nowUs = us; }
+
+unsigned long simNowUs()         { return nowUs; }
+unsigned long simLoopPasses()    { return passes; }
+unsigned long simMissedSamples() { return missed; }
+int           simServoAngle(int ch) { return servos[ch]; }
+
+const std::vector<SimServoEvent> &simServoTrace() { return servoTrace; }
+const std::vector<SimStateEvent> &simStateTrace() { return stateTrace; }
+const std::vector<SimRmsEvent>   &simRmsTrace()   { return rmsTrace; }
+const std::vector<SimLogLine>    &simLog()        { return logLines; }
+const std::vector<SimI2cEvent>   &simI2cTrace()   { return i2cTrace; }
+
+// ===================================================
+//  UART
+// ===================================================
+static void uartWrite(const char *data, size_t len) {
+  if (uartSink) uartSink(data, len, uartCtx);
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+    if (c == '\r') continue;
+    if (c != '\n') { lineBuf += c; continue; }
+    if (keepTelemetry || lineBuf.empty() || lineBuf[0] != '>' || lineBuf[1] == '>') {
+      SimLogLine l = { nowUs / 1000, lineBuf };
+      logLines.push_back(l);
+    }
+    lineBuf.clear();
+  }
+}
+
+// ===================================================
+//  HAL — virtual time
+// ===================================================
+unsigned long halMillis() { return nowUs / 1000; }
+unsigned long halMicros() { return nowUs; }
+
+bool halTakeSample(int *adc) {
+  if (!pending) return false;
+  *adc      = pendingAdc;
+  takenCurrent = pendingCurrent;
+  takenUs   = pendingUs;
+  takenTick = pendingUs / SIM_TICK_US;
+  pending   = false;
+  return true;
+}
+
+void halSampleStamp(unsigned long *arrivalUs, uint32_t *seq) {
+  *arrivalUs = takenUs;
+  *seq       = (uint32_t)takenTick;
+}
+
+int halSampleCurrent() { return takenCurrent; }
+
+void halServoWrite(int ch, int angle) {
+  if (ch < 0 || ch >= NUM_ACTUATORS) return;
+  servos[ch] = angle;
+  if (!tracing) return;
+  SimServoEvent e = { nowUs / 1000, (uint8_t)ch, (int16_t)angle };
+  servoTrace.push_back(e);
+}
+
+// ===================================================
+//  I2C — fake bus with a PCA9685 on it
+// ===================================================
+// Channels whose OFF registers were written take the new pulse
+static void pcaOutputs(int firstReg, int lastReg) {
+  if (pcaRegs[PCA9685_MODE1] & PCA9685_MODE1_SLEEP) return;
+  uint32_t div = pcaRegs[PCA9685_PRE_SCALE] + 1;
+  for (int ch = 0; ch < NUM_ACTUATORS; ch++) {
+    int on = PCA9685_LED0_ON_L + 4 * ch;
+    if (on + 3 < firstReg || on > lastReg) continue;
+    uint16_t counts = pcaRegs[on + 2] | (pcaRegs[on + 3] & 0x0F) << 8;
+    uint32_t us = (counts * div + PCA9685_TICK_MUL / 2) / PCA9685_TICK_MUL;
+    int angle = actPulseAngle(us);
+    if (angle != servos[ch]) halServoWrite(ch, angle);
+  }
+}
+
+bool halI2cWrite(uint8_t addr, const uint8_t *data, size_t len) {
+  // Start, address byte, data bytes (8 bits + ACK each), stop
+  unsigned long bits = (1 + len) * 9 + 2;
+  SimI2cEvent e = { nowUs, addr, (uint16_t)len,
+                    (uint16_t)((bits * 1000000UL + i2cHz - 1) / i2cHz), addr == PCA9685_ADDR };
+  if (tracing) i2cTrace.push_back(e);
+  nowUs += e.busUs;
+  if (!e.ack || len == 0) return e.ack;
+
+  uint8_t reg = data[0], first = reg;
+  bool ai = pcaRegs[PCA9685_MODE1] & PCA9685_MODE1_AI;
+  for (size_t i = 1; i < len; i++) {
+    pcaRegs[reg] = data[i];
+    if (ai && i + 1 < len) reg++;
+  }
+  pcaOutputs(first, reg);
+  return true;
+}
+
+int halSerialRead() {
+  if (keys.empty() || keys.front().ms * 1000 > nowUs) return -1;
+  char c = keys.front().c;
+  keys.pop_front();
+  return (unsigned char)c;
+}
+
+// Virtual UART drains instantly
+int halSerialTxFree() { return 4096; }
+
+void halSerialWrite(const char *data, size_t len) {
+  if (muted) return;
+  uartWrite(data, len);
+}
+
+void halPrintln(const char *s) {
+  if (muted) return;
+  uartWrite(s, strlen(s));
+  uartWrite("\r\n", 2);
+}
+
+void halPrintf(const char *fmt, ...) {
+  if (muted) return;
+  char buf[HAL_PRINTF_MAX];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (n > 0) uartWrite(buf, n < (int)sizeof(buf) ? n : sizeof(buf) - 1);
+}
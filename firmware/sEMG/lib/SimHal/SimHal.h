@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// ===================================================
+//  VIRTUAL-TIME HAL (host only)
+//
+//  Implements Hal.h against a virtual microsecond
+//  clock so the unmodified control code runs
+//  deterministically. The 1kHz sample timer, the
+//  servo bank and the UART are all simulated:
+//
+//  - samples are taken from an ADC source callback at
+//    each timer tick; ticks the loop misses are
+//    overwritten exactly like newSample on hardware.
+//    The servo current-sense channel comes from its
+//    own callback, which sees the servo angles (0 A
+//    when none is set)
+//  - each loop pass costs a fixed number of virtual
+//    microseconds, after which the clock skips ahead
+//    to the next tick, ms boundary or key press
+//  - I2C writes go to a fake bus. Each one costs its
+//    wire time on the virtual clock and is recorded;
+//    writes to a PCA9685 at PCA9685_ADDR are decoded
+//    register by register and move the servos as
+//    halServoWrite() would. Other addresses NACK
+//
+//  All simulator state is thread-local, so each
+//  thread can drive its own firmware instance.
+// ===================================================
+
+typedef int (*SimAdcSource)(unsigned long sampleIndex, void *ctx);
+typedef int (*SimCurrentSource)(unsigned long sampleIndex, const int *servos, void *ctx);
+typedef void (*SimUartSink)(const char *data, size_t len, void *ctx);
+
+struct SimServoEvent {
+  unsigned long ms;
+  uint8_t ch;
+  int16_t angle;
+};
+
+struct SimStateEvent {
+  unsigned long ms;
+  int state;
+};
+
+struct SimRmsEvent {
+  unsigned long ms;
+  float rms;
+};
+
+struct SimI2cEvent {
+  unsigned long us;       // start of the transaction
+  uint8_t  addr;
+  uint16_t len;           // data bytes after the address
+  uint16_t busUs;         // wire time
+  bool     ack;
+};
+
+struct SimLogLine {
+  unsigned long ms;
+  std::string text;
+};
+
+void simReset(unsigned long startUs = 0);
+void simSetAdcSource(SimAdcSource src, void *ctx);
+void simSetCurrentSource(SimCurrentSource src, void *ctx);
+void simSetUartSink(SimUartSink sink, void *ctx);
+void simSetLoopCostUs(unsigned long us);
+void simCaptureTelemetry(bool on);
+// Drop all UART output (batch replay does not need it)
+void simMuteUart(bool on);
+void simTraceServos(bool on);
+// Fake I2C bus clock (default 400 kHz)
+void simSetI2cHz(unsigned long hz);
+// Forget recorded traces so long replays keep memory flat
+void simClearTraces();
+void simPushKey(unsigned long atMs, char c);
+
+// Run gripLoop() until the virtual clock reaches ms
+void simRunUntilMs(unsigned long ms);
+// Set the clock directly, for tools that run single
+// tasks (schedPass with a mask) instead of gripLoop
+void simSetNowUs(unsigned long us);
+
+unsigned long simNowUs();
+unsigned long simLoopPasses();
+unsigned long simMissedSamples();
+int           simServoAngle(int ch);
+
+const std::vector<SimServoEvent> &simServoTrace();
+const std::vector<SimStateEvent> &simStateTrace();
+// rmsValue after every pass that changed it (ground truth for telemetry)
+const std::vector<SimRmsEvent>   &simRmsTrace();
+const std::vector<SimI2cEvent>   &simI2cTrace();
+const std::vector<SimLogLine>    &simLog();
@@ -0,0 +1,294 @@
+#include "Teleplot.h"
+
+#include <Deadline.h>
+#include <GripForce.h>
+#include <Hal.h>
+#include <Scheduler.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+static const uint8_t  PRESETS[] = TELEM_PRESETS;
+static const uint16_t PERIODS[] = TELEM_PERIODS_MS;
+
+struct FieldDef {
+  const char *name;
+  uint8_t     len;
+  uint8_t     decimals;
+};
+
+static const FieldDef FIELDS[TELEM_FIELD_COUNT] = {
+  { "rms",       3, 4 },
+  { "threshold", 9, 4 },
+  { "muscle",    6, 1 },
+  { "angle",     5, 1 },
+  { "state",     5, 1 },
+  { "current",   7, 3 },
+  { "overruns",  8, 0 },
+  { "pass_us",   7, 0 },
+};
+
+#define VALUE_ROOM 24   // longest value telemFormatFixed writes, plus '\n'
+
+static GRIP_STATE uint8_t    fields = TELEM_DEFAULT;
+static GRIP_STATE int        preset = 0;
+static GRIP_STATE int        rate   = 0;
+static GRIP_STATE int        decimPreset = 0;
+static GRIP_STATE uint8_t    decimMask   = 0;   // fields not in TELEM_DECIM_LAST
+static GRIP_STATE TelemStats stats;
+
+static inline TelemStore &store() { return arenaStore<TelemStore, ARENA_TELEMETRY>(); }
+
+// ===================================================
+//  FIXED-POINT FORMAT
+//  A float is man * 2^shift exactly; scaling by
+//  10^decimals first keeps everything in 64 bits for
+//  |v| < 2^43, and the shifted-out bits decide the
+//  rounding.
+// ===================================================
+char *telemFormatFixed(char *p, char *end, float v, int decimals) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  int      exp = (bits >> 23) & 0xFF;
+  uint32_t man = bits & 0x7FFFFF;
+  int      shift;
+  if (exp == 0xFF || exp - 150 >= 20) {
+    // inf / nan / huge: not worth a fast path
+    int n = snprintf(p, end - p, "%.*f", decimals, v);
+    return n < 0 ? p : n < end - p ? p + n : end - 1;
+  }
+  if (exp) { man |= 0x800000; shift = exp - 150; }
+  else     { shift = -149; }
+
+  uint64_t scaled = (uint64_t)man * POW10[decimals];   // < 2^44
+  uint64_t q;
+  if (shift >= 0) {
+    q = scaled << shift;
+  } else if (-shift >= 64) {
+    q = 0;                                             // < 0.5 ulp of the output
+  } else {
+    int      s    = -shift;
+    uint64_t rem  = scaled & ((1ULL << s) - 1);
+    uint64_t half = 1ULL << (s - 1);
+    q = scaled >> s;
+    if (rem > half || (rem == half && (q & 1))) q++;
+  }
+
+  char digits[24];
+  int  n = 0;
+  do { digits[n++] = (char)('0' + q % 10); q /= 10; } while (q || n <= decimals);
+
+  if (end - p < n + 3) return p;
+  if (bits >> 31) *p++ = '-';
+  for (int i = n - 1; i >= decimals; i--) *p++ = digits[i];
+  if (decimals) {
+    *p++ = '.';
+    for (int i = decimals - 1; i >= 0; i--) *p++ = digits[i];
+  }
+  return p;
+}
+
+// ===================================================
+//  FIELD VALUES
+// ===================================================
+static float fieldValue(int f) {
+  switch (f) {
+    case TELEM_RMS:       return rmsValue;
+    case TELEM_THRESHOLD: return threshold;
+    case TELEM_MUSCLE:    return muscleActive ? 1.0f : 0.0f;
+    case TELEM_ANGLE:     return (float)servoAngle;
+    case TELEM_STATE:     return (float)handState;
+    case TELEM_CURRENT:   return forceCurrent();
+    case TELEM_OVERRUNS:  return (float)deadlineOverruns();
+    case TELEM_PASS_US:   return (float)deadlineTakePeakUs();
+  }
+  return 0;
+}
+
+// ">name<suffix>:value\n"; false (and nothing written) if it does not fit
+static bool putLine(char *&p, char *end, const FieldDef &d,
+                    const char *suffix, float v) {
+  size_t s = strlen(suffix);
+  if (end - p < (long)(d.len + s + 2 + VALUE_ROOM)) return false;
+  *p++ = '>';
+  memcpy(p, d.name, d.len);
+  p += d.len;
+  memcpy(p, suffix, s);
+  p += s;
+  *p++ = ':';
+  p = telemFormatFixed(p, end - 1, v, d.decimals);
+  *p++ = '\n';
+  return true;
+}
+
+// ===================================================
+//  DECIMATION
+// ===================================================
+static void decimClear(Decim &z) {
+  uint8_t mode = z.mode;
+  memset(&z, 0, sizeof(z));
+  z.mode = mode;
+}
+
+void telemObserve(unsigned long nowMs) {
+  if (!decimMask) return;
+  for (int f = 0; f < TELEM_DECIM_FIELDS; f++) {
+    if (!(decimMask & TELEM_BIT(f))) continue;
+    Decim &z = store().decim[f];
+    float v = fieldValue(f);
+    if (z.n == 0) {
+      z.min = z.max = v;
+      z.start[z.cur] = nowMs;
+    }
+    if (v < z.min) z.min = v;
+    if (v > z.max) z.max = v;
+    z.sum += v;
+    z.n++;
+    if (z.mode != TELEM_DECIM_LTTB) continue;
+    unsigned long dt = nowMs - z.start[z.cur];
+    if (dt > 255) dt = 255;
+    z.sumDt += (float)dt;
+    uint8_t &c = z.count[z.cur];
+    if (c < TELEM_LTTB_POINTS) {
+      z.dt[z.cur][c] = (uint8_t)dt;
+      z.v[z.cur][c]  = v;
+      c++;
+    }
+  }
+}
+
+// Closes bucket C. Picks B's point with the largest triangle
+// against A and C's mean, or returns false while B is empty.
+static bool lttbPick(Decim &z, float *out) {
+  int b = z.cur ^ 1, c = z.cur;
+  bool picked = false;
+  if (z.haveB && z.count[b]) {
+    if (!z.haveA) {
+      z.haveA = true;
+      z.ta = z.start[b] + z.dt[b][0];
+      z.va = z.v[b][0];
+    }
+    // Times relative to A keep the floats small
+    float xc, yc;
+    if (z.n) {
+      xc = (float)(z.start[c] - z.ta) + z.sumDt / z.n;
+      yc = z.sum / z.n;
+    } else {
+      xc = (float)(z.start[b] - z.ta) + z.dt[b][z.count[b] - 1];
+      yc = z.v[b][z.count[b] - 1];
+    }
+    int best = 0;
+    float bestArea = -1;
+    for (int i = 0; i < z.count[b]; i++) {
+      float xb = (float)(z.start[b] - z.ta) + z.dt[b][i];
+      float area = fabsf(xc * (z.v[b][i] - z.va) - xb * (yc - z.va));
+      if (area > bestArea) { bestArea = area; best = i; }
+    }
+    z.ta = z.start[b] + z.dt[b][best];
+    z.va = z.v[b][best];
+    *out = z.va;
+    picked = true;
+  }
+  // C becomes B; its samples stay for the next pick
+  z.haveB = z.n > 0;
+  z.cur   = (uint8_t)b;
+  z.count[b] = 0;
+  z.n     = 0;
+  z.sum   = 0;
+  z.sumDt = 0;
+  return picked;
+}
+
+static void decimLines(char *&p, char *end, int f) {
+  const FieldDef &d = FIELDS[f];
+  Decim &z = store().decim[f];
+  if (z.mode == TELEM_DECIM_LTTB) {
+    float v;
+    if (lttbPick(z, &v)) putLine(p, end, d, "", v);
+    return;
+  }
+  // No samples this interval (sampling stalled): the current value
+  float now = fieldValue(f);
+  if (putLine(p, end, d, "", z.n ? z.sum / z.n : now) &&
+      putLine(p, end, d, "_min", z.n ? z.min : now))
+    putLine(p, end, d, "_max", z.n ? z.max : now);
+  z.n   = 0;
+  z.sum = 0;
+}
+
+// ===================================================
+//  FRAME
+// ===================================================
+size_t telemFormat(char *buf, size_t size, uint8_t mask) {
+  char *p = buf, *end = buf + size;
+  for (int f = 0; f < TELEM_FIELD_COUNT; f++) {
+    if (!(mask & TELEM_BIT(f))) continue;
+    if (decimMask & TELEM_BIT(f)) decimLines(p, end, f);
+    else if (!putLine(p, end, FIELDS[f], "", fieldValue(f))) break;
+  }
+  return p - buf;
+}
+
+void telemSend() {
+  if (!fields) return;
+  char *frame = store().frame;
+  size_t n = telemFormat(frame, TELEM_FRAME_BYTES, fields);
+  if (halSerialTxFree() < (int)n) { stats.dropped++; return; }
+  halSerialWrite(frame, n);
+  stats.frames++;
+}
+
+// ===================================================
+//  CONFIG
+// ===================================================
+void telemReset() {
+  fields = TELEM_DEFAULT;
+  preset = 0;
+  rate   = 0;
+  decimPreset = 0;
+  decimMask   = 0;
+  memset(store().decim, 0, sizeof(store().decim));
+  memset(&stats, 0, sizeof(stats));
+}
+
+void telemSetFields(uint8_t mask) { fields = mask & TELEM_ALL; }
+void telemSetPeriod(uint16_t ms)  { schedSetPeriod(TASK_TELEMETRY, ms); }
+
+void telemSetDecim(int field, TelemDecim mode) {
+  if (field < 0 || field >= TELEM_DECIM_FIELDS) return;
+  Decim &z = store().decim[field];
+  z.mode = (uint8_t)mode;
+  decimClear(z);
+  if (mode == TELEM_DECIM_LAST) decimMask &= ~TELEM_BIT(field);
+  else                          decimMask |= TELEM_BIT(field);
+}
+
+TelemDecim telemDecim(int field) {
+  if (field < 0 || field >= TELEM_DECIM_FIELDS) return TELEM_DECIM_LAST;
+  return (TelemDecim)store().decim[field].mode;
+}
+
+void telemCycleFields() {
+  preset = (preset + 1) % (int)sizeof(PRESETS);
+  telemSetFields(PRESETS[preset]);
+  halPrintf("Telemetry fields -> 0x%02x (%lu dropped)\n", fields, (unsigned long)stats.dropped);
+}
+
+void telemCycleRate() {
+  rate = (rate + 1) % (int)(sizeof(PERIODS) / sizeof(PERIODS[0]));
+  telemSetPeriod(PERIODS[rate]);
+  halPrintf("Telemetry rate -> %u Hz (%lu dropped)\n", 1000u / PERIODS[rate],
+            (unsigned long)stats.dropped);
+}
+
+void telemCycleDecim() {
+  static const char *NAMES[] = { "off", "min/max", "LTTB" };
+  decimPreset = (decimPreset + 1) % 3;
+  for (int f = 0; f < TELEM_DECIM_FIELDS; f++)
+    telemSetDecim(f, (TELEM_DECIM_SIGNALS & TELEM_BIT(f)) ? (TelemDecim)decimPreset
+                                                          : TELEM_DECIM_LAST);
+  halPrintf("Telemetry decimation -> %s\n", NAMES[decimPreset]);
+}
+
+const TelemStats &telemStats() { return stats; }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Arena.h>
+#include <GripControl.h>
+
+// ===================================================
+//  TELEPLOT OUTPUT
+//
+//  The ">name:value" lines for Teleplot, byte for byte
+//  what printf("%.4f") / ("%.1f") produced, without
+//  printf:
+//
+//  - values are converted from the float's bits with
+//    integer arithmetic only (exact, round-half-even
+//    like printf), at a cost that does not depend on
+//    the value
+//  - a whole frame is built in one static buffer and
+//    handed to the UART driver in a single write. If
+//    the TX buffer cannot take the frame, the frame is
+//    dropped and counted, and the loop never blocks
+//
+//  'f' cycles the field set, 'p' the rate, 'w' the
+//  decimation.
+// ===================================================
+#define TELEM_FRAME_BYTES  384
+#define TELEM_PERIODS_MS   { PLOT_MS, 10, 5 }     // 'p' cycles: 50, 100, 200 Hz
+
+enum TelemField {
+  TELEM_RMS,          // %.4f
+  TELEM_THRESHOLD,    // %.4f
+  TELEM_MUSCLE,       // %.1f
+  TELEM_ANGLE,        // %.1f
+  TELEM_STATE,        // %.1f
+  TELEM_CURRENT,      // servo supply amps, %.3f
+  TELEM_OVERRUNS,     // deadline overruns, all classes
+  TELEM_PASS_US,      // worst loop pass since the last frame
+  TELEM_FIELD_COUNT
+};
+
+#define TELEM_BIT(f)  (1u << (f))
+#define TELEM_DEFAULT 0x1F      // the original five lines
+#define TELEM_HEALTH  (TELEM_BIT(TELEM_OVERRUNS) | TELEM_BIT(TELEM_PASS_US))
+#define TELEM_ALL     (TELEM_DEFAULT | TELEM_BIT(TELEM_CURRENT) | TELEM_HEALTH)
+#define TELEM_EMG     (TELEM_BIT(TELEM_RMS) | TELEM_BIT(TELEM_THRESHOLD) | TELEM_BIT(TELEM_MUSCLE))
+#define TELEM_GRIP    (TELEM_BIT(TELEM_ANGLE) | TELEM_BIT(TELEM_STATE) | TELEM_BIT(TELEM_CURRENT))
+// 'f' cycles: default, default + health, EMG only, RMS only, grip, off
+#define TELEM_PRESETS { TELEM_DEFAULT, TELEM_ALL, TELEM_EMG, TELEM_BIT(TELEM_RMS), TELEM_GRIP, 0 }
+
+// ===================================================
+//  DECIMATION
+//
+//  A frame every 20 ms shows one sample in twenty, so
+//  a spike that trips updateMuscle() can fall between
+//  frames. Each signal field can instead summarize the
+//  whole interval, fed sample by sample from the
+//  sample task:
+//
+//  - MINMAX sends the interval mean under the field's
+//    own name plus "<name>_min" / "<name>_max", so
+//    every excursion shows up in the max/min traces
+//  - LTTB (largest triangle three buckets) sends one
+//    real sample per interval: the one spanning the
+//    largest triangle with the previous pick and the
+//    next interval's mean. Frames run one interval
+//    behind, and only the first TELEM_LTTB_POINTS
+//    samples of an interval are candidates
+//
+//  Only the first TELEM_DECIM_FIELDS fields (the
+//  signals) can be decimated; the health fields are
+//  counters and peaks already.
+// ===================================================
+#define TELEM_DECIM_FIELDS  TELEM_OVERRUNS
+#define TELEM_LTTB_POINTS   32
+
+enum TelemDecim {
+  TELEM_DECIM_LAST,     // value at frame time (original behaviour)
+  TELEM_DECIM_MINMAX,
+  TELEM_DECIM_LTTB,
+};
+
+// 'w' cycles: off, min/max on the plotted signals, LTTB on the plotted signals
+#define TELEM_DECIM_SIGNALS (TELEM_BIT(TELEM_RMS) | TELEM_BIT(TELEM_ANGLE))
+
+// Running summary of one field over the current interval.
+// LTTB keeps the previous interval's samples (bucket B)
+// while the current one (C) fills.
+struct Decim {
+  uint8_t       mode;
+  uint16_t      n;
+  float         min, max, sum;
+  float         sumDt;                       // for C's mean time
+  uint8_t       cur;                         // bucket filling: C = cur, B = cur ^ 1
+  bool          haveB, haveA;
+  uint8_t       count[2];
+  unsigned long start[2];
+  uint8_t       dt[2][TELEM_LTTB_POINTS];    // ms after start
+  float         v[2][TELEM_LTTB_POINTS];
+  unsigned long ta;                          // previous pick (point A)
+  float         va;
+};
+
+// Frame buffer and decimators (lib/Arena, ARENA_TELEMETRY)
+struct TelemStore {
+  char  frame[TELEM_FRAME_BYTES];
+  Decim decim[TELEM_DECIM_FIELDS];
+};
+
+struct TelemStats {
+  uint32_t frames;
+  uint32_t dropped;    // UART had no room for the frame
+};
+
+// printf("%.*f", decimals, v) into [p, end); returns the new end.
+// decimals: 0..6
+char  *telemFormatFixed(char *p, char *end, float v, int decimals);
+// One frame of the current values for the fields in `mask`
+size_t telemFormat(char *buf, size_t size, uint8_t mask);
+
+void  telemReset();
+void  telemSetFields(uint8_t mask);
+void  telemSetPeriod(uint16_t ms);
+void  telemSetDecim(int field, TelemDecim mode);
+TelemDecim telemDecim(int field);
+// Feed the decimators one sample (sample task)
+void  telemObserve(unsigned long nowMs);
+// Build and queue one frame (telemetry task)
+void  telemSend();
+// 'f' / 'p'
+void  telemCycleFields();
+void  telemCycleRate();
+void  telemCycleDecim();
+const TelemStats &telemStats();
@@ -0,0 +1,292 @@
+#include "UsageStats.h"
+
+#include <ConfigStore.h>
+#include <Hal.h>
+#include <string.h>
+
+#define USAGE_RING_BYTES ((uint32_t)USAGE_SECTOR_SIZE * USAGE_RING_SECTORS)
+#define USAGE_SLOTS      (USAGE_RING_BYTES / USAGE_SLOT_SIZE)
+
+// ===================================================
+//  FLASH BACKEND
+// ===================================================
+#ifdef ARDUINO
+#include <esp_partition.h>
+
+static const esp_partition_t *part = nullptr;
+
+static bool ringOpen(const char *) {
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  ESP_PARTITION_SUBTYPE_ANY, "usage");
+  return part && part->size >= USAGE_RING_BYTES;
+}
+
+static bool ringRead(uint32_t off, void *buf, size_t len) {
+  return esp_partition_read(part, off, buf, len) == ESP_OK;
+}
+
+static bool ringWrite(uint32_t off, const void *buf, size_t len) {
+  return esp_partition_write(part, off, buf, len) == ESP_OK;
+}
+
+static bool ringErase(uint32_t off) {
+  return esp_partition_erase_range(part, off, USAGE_SECTOR_SIZE) == ESP_OK;
+}
+
+#else
+#include <stdio.h>
+
+static GRIP_STATE FILE *ringFile = nullptr;
+
+static bool ringOpen(const char *path) {
+  if (ringFile) { fclose(ringFile); ringFile = nullptr; }
+  if (!path || !path[0]) return false;
+  ringFile = fopen(path, "r+b");
+  if (!ringFile) {
+    // New ring: erased flash reads as 0xFF
+    ringFile = fopen(path, "w+b");
+    if (!ringFile) return false;
+    uint8_t erased[USAGE_SECTOR_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    for (int s = 0; s < USAGE_RING_SECTORS; s++)
+      fwrite(erased, 1, sizeof(erased), ringFile);
+    fflush(ringFile);
+  }
+  return true;
+}
+
+static bool ringRead(uint32_t off, void *buf, size_t len) {
+  return fseek(ringFile, off, SEEK_SET) == 0 && fread(buf, 1, len, ringFile) == len;
+}
+
+static bool ringWrite(uint32_t off, const void *buf, size_t len) {
+  bool ok = fseek(ringFile, off, SEEK_SET) == 0 && fwrite(buf, 1, len, ringFile) == len;
+  return fflush(ringFile) == 0 && ok;
+}
+
+static bool ringErase(uint32_t off) {
+  uint8_t erased[USAGE_SECTOR_SIZE];
+  memset(erased, 0xFF, sizeof(erased));
+  return ringWrite(off, erased, sizeof(erased));
+}
+#endif
+
+// ===================================================
+//  STATE
+// ===================================================
+static const uint32_t HIST_EDGES[USAGE_HIST_BINS - 1] = USAGE_HIST_EDGES_MS;
+
+static GRIP_STATE bool          ringReady   = false;
+static GRIP_STATE uint32_t      headSlot    = 0;
+static GRIP_STATE uint32_t      lastSeq     = 0;
+static GRIP_STATE uint32_t      bootCount   = 0;
+static GRIP_STATE uint32_t      bucketIndex = 0;
+
+static GRIP_STATE UsageCounters bucketCounts;
+static GRIP_STATE UsageCounters lifetime;
+static GRIP_STATE HandState     curState    = IDLE;
+static GRIP_STATE unsigned long stateSince  = 0;   // entry into curState
+static GRIP_STATE unsigned long accountedAt = 0;   // stateMs counted up to here
+static GRIP_STATE unsigned long bucketStart = 0;
+
+static void addCounters(UsageCounters &to, const UsageCounters &from) {
+  to.grips            += from.grips;
+  to.holds            += from.holds;
+  to.aborts           += from.aborts;
+  to.forceOpens       += from.forceOpens;
+  to.thresholdChanges += from.thresholdChanges;
+  for (int s = 0; s < 4; s++) {
+    to.stateMs[s] += from.stateMs[s];
+    for (int b = 0; b < USAGE_HIST_BINS; b++) to.dwell[s][b] += from.dwell[s][b];
+  }
+}
+
+static uint32_t recordCrc(const UsageRecord &r) {
+  return configCrc32(&r, offsetof(UsageRecord, crc));
+}
+
+static bool readRecord(uint32_t slot, UsageRecord &r) {
+  if (!ringRead(slot * USAGE_SLOT_SIZE, &r, sizeof(r))) return false;
+  return r.magic == USAGE_MAGIC && r.crc == recordCrc(r);
+}
+
+// ===================================================
+//  SETUP
+// ===================================================
+bool usageBegin(const char *path) {
+  ringReady = ringOpen(path);
+  return ringReady;
+}
+
+void usageReset() {
+  memset(&bucketCounts, 0, sizeof(bucketCounts));
+  memset(&lifetime, 0, sizeof(lifetime));
+  headSlot = lastSeq = bootCount = bucketIndex = 0;
+  curState = IDLE;
+  stateSince = accountedAt = bucketStart = 0;
+}
+
+// Newest record = highest sequence number with a valid CRC. Only
+// headers are scanned; the CRC is checked on the winner alone, and a
+// torn record just drops out of the next round.
+void usageRestore() {
+  unsigned long now = halMillis();
+  uint8_t bad[(USAGE_SLOTS + 7) / 8] = {0};
+  UsageRecord rec;
+  bool found = false;
+
+  while (ringReady && !found) {
+    int32_t best = -1;
+    uint32_t bestSeq = 0;
+    for (uint32_t s = 0; s < USAGE_SLOTS; s++) {
+      if (bad[s / 8] & (1 << (s % 8))) continue;
+      uint32_t hdr[2];
+      if (!ringRead(s * USAGE_SLOT_SIZE, hdr, sizeof(hdr)) || hdr[0] != USAGE_MAGIC) continue;
+      if (best < 0 || (int32_t)(hdr[1] - bestSeq) > 0) { best = (int32_t)s; bestSeq = hdr[1]; }
+    }
+    if (best < 0) break;
+    if (readRecord((uint32_t)best, rec)) {
+      found = true;
+      lifetime  = rec.lifetime;
+      lastSeq   = rec.seq;
+      bootCount = rec.boot;
+      headSlot  = ((uint32_t)best + 1) % USAGE_SLOTS;
+    } else {
+      bad[best / 8] |= 1 << (best % 8);
+    }
+  }
+
+  // Flash only programs 1 -> 0: never reuse a slot a torn write left
+  // dirty, move on to the next sector (erased on entry) instead
+  uint32_t blank[2];
+  if (ringReady && ringRead(headSlot * USAGE_SLOT_SIZE, blank, sizeof(blank)) &&
+      (blank[0] != 0xFFFFFFFFUL || blank[1] != 0xFFFFFFFFUL)) {
+    const uint32_t perSector = USAGE_SECTOR_SIZE / USAGE_SLOT_SIZE;
+    headSlot = ((headSlot / perSector + 1) * perSector) % USAGE_SLOTS;
+  }
+
+  bootCount++;
+  bucketIndex = 0;
+  memset(&bucketCounts, 0, sizeof(bucketCounts));
+  curState    = handState;
+  stateSince  = accountedAt = bucketStart = now;
+}
+
+// ===================================================
+//  EVENTS — O(1), called from the control loop
+// ===================================================
+void usageTransition(HandState from, HandState to, unsigned long now) {
+  unsigned long dwell = now - stateSince;
+  int bin = 0;
+  while (bin < USAGE_HIST_BINS - 1 && dwell >= HIST_EDGES[bin]) bin++;
+  bucketCounts.dwell[from][bin]++;
+  bucketCounts.stateMs[from] += now - accountedAt;
+
+  if (from == IDLE    && to == CLOSING) bucketCounts.grips++;
+  if (from == CLOSING && to == HOLDING) bucketCounts.holds++;
+  if (from == CLOSING && to == OPENING) bucketCounts.aborts++;
+
+  curState   = to;
+  stateSince = accountedAt = now;
+}
+
+void usageForceOpen(HandState from, unsigned long now) {
+  bucketCounts.forceOpens++;
+  if (from != OPENING) usageTransition(from, OPENING, now);
+}
+
+void usageThresholdChange() {
+  bucketCounts.thresholdChanges++;
+}
+
+// ===================================================
+//  BUCKETS
+// ===================================================
+void usageFlush(unsigned long now) {
+  bucketCounts.stateMs[curState] += now - accountedAt;
+  accountedAt = now;
+  addCounters(lifetime, bucketCounts);
+
+  if (ringReady) {
+    UsageRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.magic        = USAGE_MAGIC;
+    rec.seq          = lastSeq + 1;
+    rec.boot         = bootCount;
+    rec.bucket       = bucketIndex;
+    rec.threshold    = threshold;
+    rec.bucketCounts = bucketCounts;
+    rec.lifetime     = lifetime;
+    rec.crc          = recordCrc(rec);
+
+    uint32_t off = headSlot * USAGE_SLOT_SIZE;
+    bool ok = (off % USAGE_SECTOR_SIZE != 0) || ringErase(off);
+    if (ok && ringWrite(off, &rec, sizeof(rec))) {
+      lastSeq  = rec.seq;
+      headSlot = (headSlot + 1) % USAGE_SLOTS;
+    }
+  }
+
+  bucketIndex++;
+  memset(&bucketCounts, 0, sizeof(bucketCounts));
+  bucketStart = now;
+}
+
+void usageTick(unsigned long now) {
+  unsigned long age = now - bucketStart;
+  if (age < USAGE_BUCKET_MS) return;
+  bool quiet = handState == IDLE && !muscleActive;
+  if (quiet || age >= USAGE_BUCKET_MS + USAGE_FLUSH_SLACK_MS) usageFlush(now);
+}
+
+void usageLifetime(UsageCounters *out) {
+  *out = lifetime;
+  addCounters(*out, bucketCounts);
+}
+
+// ===================================================
+//  SUMMARY
+//  Printed in short pieces: the target's halPrintf
+//  buffer is 128 bytes.
+// ===================================================
+static void printCounts(const char *key, const uint32_t *v, int n) {
+  halPrintf("\"%s\":[", key);
+  for (int i = 0; i < n; i++) halPrintf(i ? ",%lu" : "%lu", (unsigned long)v[i]);
+  halPrintf("]");
+}
+
+void usagePrintSummary(unsigned long now) {
+  UsageCounters life;
+  usageLifetime(&life);
+  // The open bucket's state time is only folded in at flush
+  life.stateMs[curState] += now - accountedAt;
+
+  halPrintf("USAGE {\"v\":1,\"boot\":%lu,\"uptime_s\":%lu,\"bucket_s\":%lu,",
+            (unsigned long)bootCount, now / 1000, USAGE_BUCKET_MS / 1000);
+  halPrintf("\"grips\":%lu,\"holds\":%lu,\"aborts\":%lu,\"force_opens\":%lu,\"thr_changes\":%lu,",
+            (unsigned long)life.grips, (unsigned long)life.holds,
+            (unsigned long)life.aborts, (unsigned long)life.forceOpens,
+            (unsigned long)life.thresholdChanges);
+  printCounts("state_ms", life.stateMs, 4);
+  halPrintf(",\"dwell\":{");
+  for (int s = 0; s < 4; s++) {
+    if (s) halPrintf(",");
+    printCounts(s == IDLE ? "idle" : s == CLOSING ? "closing" : s == HOLDING ? "holding" : "opening",
+                life.dwell[s], USAGE_HIST_BINS);
+  }
+
+  // Recent buckets, newest first: [grips, force opens, threshold changes]
+  halPrintf("},\"recent\":[[%lu,%lu,%lu]", (unsigned long)bucketCounts.grips,
+            (unsigned long)bucketCounts.forceOpens, (unsigned long)bucketCounts.thresholdChanges);
+  uint32_t slot = headSlot, seq = lastSeq;
+  for (int i = 0; ringReady && i < USAGE_RECENT - 1; i++) {
+    slot = (slot + USAGE_SLOTS - 1) % USAGE_SLOTS;
+    UsageRecord rec;
+    if (!readRecord(slot, rec) || rec.seq != seq) break;
+    halPrintf(",[%lu,%lu,%lu]", (unsigned long)rec.bucketCounts.grips,
+              (unsigned long)rec.bucketCounts.forceOpens,
+              (unsigned long)rec.bucketCounts.thresholdChanges);
+    seq--;
+  }
+  halPrintf("]}\n");
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <GripControl.h>
+
+// ===================================================
+//  USAGE ANALYTICS
+//
+//  Counters fed from hand-state transitions, kept in
+//  RAM (O(1) per event) and written once per time
+//  bucket to a flash ring:
+//
+//  - the ring is USAGE_RING_SECTORS erase sectors of
+//    fixed-size slots; records carry a sequence number
+//    and CRC, so boot finds the newest by one scan and
+//    a torn write is simply skipped
+//  - a sector is erased only when the head enters it,
+//    which spreads wear evenly over the whole ring
+//  - each record holds that bucket's counters and the
+//    lifetime totals, so history survives wrap-around
+//
+//  Flushes wait for a quiet moment (hand IDLE, muscle
+//  at rest) because a sector erase blocks the CPU.
+//
+//  Target: a dedicated "usage" data partition.
+//  Host:   a file (usageBegin) or nothing at all.
+// ===================================================
+#define USAGE_BUCKET_MS      (15UL * 60 * 1000)
+#define USAGE_FLUSH_SLACK_MS (60UL * 1000)   // flush anyway once this overdue
+#define USAGE_SECTOR_SIZE    4096
+#define USAGE_RING_SECTORS   32
+#define USAGE_SLOT_SIZE      512
+#define USAGE_HIST_BINS      8
+#define USAGE_RECENT         24              // buckets in the summary
+#define USAGE_MAGIC          0x55534731UL    // "USG1"
+
+// Dwell-time histogram bin upper edges (ms); the last bin is open
+#define USAGE_HIST_EDGES_MS { 100, 250, 500, 1000, 2000, 5000, 10000 }
+
+struct UsageCounters {
+  uint32_t grips;             // IDLE -> CLOSING
+  uint32_t holds;             // CLOSING -> HOLDING
+  uint32_t aborts;            // CLOSING -> OPENING
+  uint32_t forceOpens;        // 'o' command
+  uint32_t thresholdChanges;  // '+' / '-'
+  uint32_t stateMs[4];        // time spent per HandState
+  uint32_t dwell[4][USAGE_HIST_BINS];
+};
+
+struct UsageRecord {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t boot;              // boot count when written
+  uint32_t bucket;            // bucket index within that boot
+  float    threshold;
+  UsageCounters bucketCounts;
+  UsageCounters lifetime;
+  uint32_t crc;               // over everything above
+};
+
+static_assert(sizeof(UsageRecord) <= USAGE_SLOT_SIZE, "usage record exceeds its slot");
+static_assert(USAGE_SECTOR_SIZE % USAGE_SLOT_SIZE == 0, "slots must tile a sector");
+
+// Host: persist the ring in this file; empty keeps it in RAM only.
+// Target: ignored (the partition is fixed).
+bool usageBegin(const char *path = "");
+// Zero all counters (power-on)
+void usageReset();
+// Load lifetime totals from the newest ring record and count a boot
+void usageRestore();
+
+void usageTransition(HandState from, HandState to, unsigned long now);
+void usageForceOpen(HandState from, unsigned long now);
+void usageThresholdChange();
+// Once per loop pass: closes buckets and flushes when quiet
+void usageTick(unsigned long now);
+// Write the open bucket now (e.g. before a planned power-off)
+void usageFlush(unsigned long now);
+
+// Lifetime totals including the open bucket
+void usageLifetime(UsageCounters *out);
+// One-line JSON summary on the UART ('u' command)
+void usagePrintSummary(unsigned long now);
@@ -0,0 +1,90 @@
+#include "WorkPool.h"
+
+// Pool and index of the worker running on this thread
+struct CurrentWorker {
+  const WorkPool *pool;
+  unsigned        index;
+};
+
+static thread_local CurrentWorker currentWorker = { nullptr, 0 };
+
+WorkPool::WorkPool(unsigned threads) {
+  if (threads == 0) threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  queues = std::vector<Queue>(threads);
+  for (unsigned i = 0; i < threads; i++)
+    workers.emplace_back(&WorkPool::run, this, i);
+}
+
+WorkPool::~WorkPool() {
+  {
+    std::lock_guard<std::mutex> lk(sleepM);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &t : workers) t.join();
+}
+
+void WorkPool::submit(Task task) {
+  // Counted and queued in one step: a stolen task can never finish
+  // (and decrement pending) before it was counted
+  std::lock_guard<std::mutex> lk(sleepM);
+  unsigned target = currentWorker.pool == this ? currentWorker.index
+                                               : nextQueue++ % queues.size();
+  {
+    std::lock_guard<std::mutex> qlk(queues[target].m);
+    queues[target].q.push_back(std::move(task));
+  }
+  queued++;
+  pending++;
+  wake.notify_one();
+}
+
+void WorkPool::wait() {
+  std::unique_lock<std::mutex> lk(sleepM);
+  idle.wait(lk, [this] { return pending == 0; });
+}
+
+bool WorkPool::pop(unsigned self, Task &task) {
+  {
+    Queue &own = queues[self];
+    std::lock_guard<std::mutex> lk(own.m);
+    if (!own.q.empty()) {
+      task = std::move(own.q.back());
+      own.q.pop_back();
+      return true;
+    }
+  }
+  for (size_t k = 1; k < queues.size(); k++) {
+    Queue &victim = queues[(self + k) % queues.size()];
+    std::lock_guard<std::mutex> lk(victim.m);
+    if (!victim.q.empty()) {
+      task = std::move(victim.q.front());
+      victim.q.pop_front();
+      stolen++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkPool::run(unsigned self) {
+  currentWorker = { this, self };
+  for (;;) {
+    Task task;
+    if (pop(self, task)) {
+      {
+        std::lock_guard<std::mutex> lk(sleepM);
+        queued--;
+      }
+      task(self);
+      std::lock_guard<std::mutex> lk(sleepM);
+      if (--pending == 0) idle.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lk(sleepM);
+    wake.wait(lk, [this] { return stopping || queued > 0; });
+    if (stopping && queued == 0) return;
+  }
+}
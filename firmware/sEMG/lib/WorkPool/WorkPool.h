@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// ===================================================
+//  WORK-STEALING THREAD POOL (host only)
+//
+//  One deque per worker. Workers pop their own queue
+//  from the back (LIFO, cache-warm) and steal from the
+//  front of the others (FIFO, oldest/largest first).
+//  Tasks submitted from inside a task of the same
+//  pool go to the calling worker's own queue; wait()
+//  covers them too.
+// ===================================================
+class WorkPool {
+public:
+  typedef std::function<void(unsigned worker)> Task;
+
+  // threads == 0 uses every core
+  explicit WorkPool(unsigned threads = 0);
+  ~WorkPool();
+
+  void     submit(Task task);
+  // Block until every submitted task has finished
+  void     wait();
+  unsigned size() const { return (unsigned)workers.size(); }
+  uint64_t steals() const { return stolen.load(); }
+
+private:
+  struct Queue {
+    std::mutex       m;
+    std::deque<Task> q;
+  };
+
+  void run(unsigned self);
+  bool pop(unsigned self, Task &task);
+
+  std::vector<std::thread> workers;
+  std::vector<Queue>       queues;
+
+  std::mutex              sleepM;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  size_t                  queued  = 0;   // guarded by sleepM
+  size_t                  pending = 0;   // guarded by sleepM
+  bool                    stopping = false;
+  unsigned                nextQueue = 0;
+  std::atomic<uint64_t>   stolen{0};
+};
@@ -0,0 +1,188 @@
+# ===================================================
+#  RAM REPORT — runs after each firmware link
+#
+#  - static DRAM (.data + .bss) and IRAM per library,
+#    from the linker map
+#  - use of each memory region against its length
+#  - the arena parts, used / budget, read from the
+#    arenaParts table in the ELF (lib/Arena)
+#
+#  PlatformIO: extra_scripts = post:scripts/ram_report.py
+#  By hand:    python scripts/ram_report.py firmware.elf firmware.map
+# ===================================================
+import os
+import re
+import struct
+import sys
+
+ARENA_SYMBOL = "arenaParts"
+ARENA_ENTRY = struct.Struct("<12sII")   # ArenaPartInfo
+TOP_LIBS = 12
+
+
+def kind(section):
+    if section.startswith(".iram"):
+        return "iram"
+    if section.startswith((".dram", ".noinit", ".data", ".bss", ".tdata", ".tbss")):
+        return "dram"
+    return None
+
+
+def owner(path):
+    m = re.search(r"([^/\\]+)\.a\(", path)
+    if m:
+        name = m.group(1)
+        return name[3:] if name.startswith("lib") else name
+    return os.path.basename(os.path.dirname(path)) or path
+
+
+# ---------------------------------------------------
+#  Linker map
+# ---------------------------------------------------
+def parse_map(path):
+    regions = []                    # (name, origin, length)
+    outputs = []                    # (name, addr, size)
+    libs = {}                       # lib -> {"dram": n, "iram": n}
+    with open(path) as f:
+        lines = f.read().splitlines()
+
+    i = 0
+    while i < len(lines) and not lines[i].startswith("Memory Configuration"):
+        i += 1
+    while i < len(lines) and not lines[i].startswith("Linker script and memory map"):
+        m = re.match(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)", lines[i])
+        if m and m.group(1) != "*default*":
+            regions.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+        i += 1
+
+    section = None
+    pending = None                  # input section name split from its line
+    for line in lines[i:]:
+        m = re.match(r"^(\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?", line)
+        if m:
+            section = m.group(1)
+            if m.group(2):
+                outputs.append((section, int(m.group(2), 16), int(m.group(3), 16)))
+            else:
+                pending = "output"
+            continue
+        if pending == "output":
+            m = re.match(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)", line)
+            if m:
+                outputs.append((section, int(m.group(1), 16), int(m.group(2), 16)))
+            pending = None
+            continue
+        k = kind(section) if section else None
+        if not k:
+            continue
+        m = re.match(r"^ (\S+)\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)\s+(\S.*)$", line)
+        if not m and pending:
+            m = re.match(r"^\s+()0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)\s+(\S.*)$", line)
+        pending = None
+        if not m:
+            if re.match(r"^ \.\S+$", line):
+                pending = "input"
+            continue
+        size = int(m.group(2), 16)
+        if size == 0:
+            continue
+        counts = libs.setdefault(owner(m.group(3)), {"dram": 0, "iram": 0})
+        counts[k] += size
+    return regions, outputs, libs
+
+
+# ---------------------------------------------------
+#  ELF (32/64-bit, little-endian): one symbol's bytes
+# ---------------------------------------------------
+def read_symbol(path, name):
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[5] != 1:
+        return None
+    wide = elf[4] == 2
+    if wide:
+        shoff, = struct.unpack_from("<Q", elf, 0x28)
+        shentsize, shnum = struct.unpack_from("<HH", elf, 0x3A)
+    else:
+        shoff, = struct.unpack_from("<I", elf, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", elf, 0x2E)
+
+    sections = []                   # (type, addr, offset, size, link, entsize)
+    for n in range(shnum):
+        at = shoff + n * shentsize
+        if wide:
+            _, typ, _, addr, off, size, link, _, _, ent = struct.unpack_from("<IIQQQQIIQQ", elf, at)
+        else:
+            _, typ, _, addr, off, size, link, _, _, ent = struct.unpack_from("<IIIIIIIIII", elf, at)
+        sections.append((typ, addr, off, size, link, ent))
+
+    want = name.encode()
+    for typ, _, off, size, link, ent in sections:
+        if typ != 2:                # SHT_SYMTAB
+            continue
+        stroff = sections[link][2]
+        for at in range(off, off + size, ent):
+            if wide:
+                nameoff, _, _, shndx, value, symsize = struct.unpack_from("<IBBHQQ", elf, at)
+            else:
+                nameoff, value, symsize, _, _, shndx = struct.unpack_from("<IIIBBH", elf, at)
+            end = elf.index(b"\0", stroff + nameoff)
+            if elf[stroff + nameoff:end] != want or shndx >= len(sections):
+                continue
+            _, saddr, soff, _, _, _ = sections[shndx]
+            start = soff + value - saddr
+            return elf[start:start + symsize]
+    return None
+
+
+# ---------------------------------------------------
+#  Report
+# ---------------------------------------------------
+def report(elf_path, map_path):
+    print("RAM REPORT %s" % elf_path)
+    if os.path.exists(map_path):
+        regions, outputs, libs = parse_map(map_path)
+        for name, origin, length in regions:
+            used = sum(s for _, a, s in outputs if s and origin <= a < origin + length)
+            if used and ("ram" in name or "RAM" in name):
+                print("  %-16s %7d of %7d bytes (%d%%)" % (name, used, length, 100 * used // length))
+        rows = sorted(libs.items(), key=lambda kv: -(kv[1]["dram"] + kv[1]["iram"]))
+        print("  %-24s %8s %8s" % ("library", "dram", "iram"))
+        for lib, c in rows[:TOP_LIBS]:
+            print("  %-24s %8d %8d" % (lib, c["dram"], c["iram"]))
+        rest = rows[TOP_LIBS:]
+        if rest:
+            print("  %-24s %8d %8d" % ("(%d more)" % len(rest),
+                                       sum(c["dram"] for _, c in rest),
+                                       sum(c["iram"] for _, c in rest)))
+    else:
+        print("  no linker map at %s" % map_path)
+
+    table = read_symbol(elf_path, ARENA_SYMBOL)
+    if not table:
+        print("  no %s table in the ELF" % ARENA_SYMBOL)
+        return
+    used = budget = 0
+    print("  %-24s %8s %8s" % ("arena part", "used", "budget"))
+    for at in range(0, len(table) - ARENA_ENTRY.size + 1, ARENA_ENTRY.size):
+        name, u, b = ARENA_ENTRY.unpack_from(table, at)
+        used += u
+        budget += b
+        print("  %-24s %8d %8d" % (name.split(b"\0")[0].decode(), u, b))
+    print("  %-24s %8d %8d" % ("arena", used, budget))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: ram_report.py firmware.elf firmware.map")
+    report(sys.argv[1], sys.argv[2])
+else:
+    Import("env")   # noqa: F821 (SCons)
+
+    map_path = os.path.join(env.subst("$BUILD_DIR"), "firmware.map")
+    env.Append(LINKFLAGS=["-Wl,-Map," + map_path])
+
+    def ram_report(target, source, env):
+        report(str(target[0]), map_path)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", ram_report)
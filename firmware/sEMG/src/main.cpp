@@ -1,91 +1,44 @@
 #include "soc/rtc_cntl_reg.h"
 #include <Arduino.h>
 #include <ESP32Servo.h>
-#include <math.h>
+#include <Wire.h>
+#include <Actuators.h>
+#include <Arena.h>
+#include <ConfigStore.h>
+#include <FingerCal.h>
+#include <FlightRecorder.h>
+#include <GripControl.h>
+#include <UsageStats.h>
+#include <Hal.h>
+#include <stdarg.h>
 
 // ===================================================
 //  PINS
 // ===================================================
 #define EMG_PIN    34
-const int SERVO_PINS[5] = {18, 19, 23, 25, 26}; // Your 5 servo pins
+#define CURRENT_PIN 35      // servo supply current-sense amplifier
+#define UART_TX_BUFFER 1024
+// ACT_DIRECT: one pin per actuator — 5 fingers, wrist, thumb rotation
+const int SERVO_PINS[NUM_ACTUATORS] = {18, 19, 23, 25, 26, 27, 33};
+// ACT_PCA9685: the expander on the default I2C pins
+#define I2C_SDA_PIN 21
+#define I2C_SCL_PIN 22
 
 // ===================================================
-//  SERVO
-// ===================================================
-#define SERVO_OPEN       0
-#define SERVO_CLOSED     130
-#define SERVO_STEP_MS    12
-
-// ===================================================
-//  EMG
-// ===================================================
-#define VREF             3.3f
-#define ADC_MAX          4095.0f
-#define MIDPOINT         1.65f
-#define WINDOW_SIZE      200
-
-// ===================================================
-//  TIMING
-// ===================================================
-#define CONFIRM_MS       300
-#define RELEASE_MS       400
-
-// ===================================================
-//  SIGNAL PROCESSING
+//  SAMPLING
 // ===================================================
 hw_timer_t   *emgTimer = NULL;
 portMUX_TYPE  timerMux = portMUX_INITIALIZER_UNLOCKED;
 volatile bool newSample = false;
 volatile int  rawADC    = 0;
+volatile int  rawCurrent = 0;
+volatile unsigned long sampleUs  = 0;
+volatile uint32_t      sampleSeq = 0;
+unsigned long takenUs  = 0;
+uint32_t      takenSeq = 0;
+int           takenCurrent = 0;
 
-float rmsBuffer[WINDOW_SIZE] = {0};
-int   rmsIndex  = 0;
-float rmsValue  = 0;
-float hp_in     = 0, hp_out = 0;
-float lp_state  = 0;
-
-// ===================================================
-//  CALIBRATION — hardcoded from your session data
-// ===================================================
-float restMean  = 0.025f;
-float restStd   = 0.008f;
-float actMean   = 0.380f;
-float threshold = 0.055f;
-bool  calibDone = true;
-int   calibPhase = 3;
-
-// ===================================================
-//  MUSCLE STATE
-// ===================================================
-bool muscleActive = false;
-bool musclePrev   = false;
-unsigned long muscleOnTime  = 0;
-unsigned long muscleOffTime = 0;
-
-// ===================================================
-//  HAND STATE MACHINE
-// ===================================================
-enum HandState { IDLE, CLOSING, HOLDING, OPENING };
-HandState handState = IDLE;
-
-int  servoAngle     = SERVO_OPEN;
-unsigned long stepTimer     = 0;
-
-// ===================================================
-//  TELEPLOT
-// ===================================================
-unsigned long plotTimer = 0;
-
-Servo fingers[5];
-
-// ===================================================
-//  HELPER: MOVE ALL SERVOS
-// ===================================================
-void moveAllFingers(int angle) {
-  for (int i = 0; i < 5; i++) {
-    fingers[i].write(angle);
-  }
-}
+Servo servos[NUM_ACTUATORS];
 
 // ===================================================
 //  ISR
@@ -93,116 +46,73 @@ void moveAllFingers(int angle) {
 void IRAM_ATTR onTimer() {
   portENTER_CRITICAL_ISR(&timerMux);
   rawADC    = analogRead(EMG_PIN);
+  rawCurrent = analogRead(CURRENT_PIN);
+  sampleUs  = micros();
+  sampleSeq++;
   newSample = true;
   portEXIT_CRITICAL_ISR(&timerMux);
 }
 
 // ===================================================
-//  FILTERS
+//  HAL — Arduino / ESP32
 // ===================================================
-float highPass(float in) {
-  const float a = 0.9747f;
-  float out = a * (hp_out + in - hp_in);
-  hp_in  = in;
-  hp_out = out;
-  return out;
-}
-float lowPass(float in) {
-  const float a = 0.7f;
-  lp_state = a * lp_state + (1.0f - a) * in;
-  return lp_state;
-}
-float computeRMS() {
-  float sum = 0;
-  for (int i = 0; i < WINDOW_SIZE; i++)
-    sum += rmsBuffer[i] * rmsBuffer[i];
-  return sqrtf(sum / WINDOW_SIZE);
+unsigned long halMillis() { return millis(); }
+unsigned long halMicros() { return micros(); }
+
+bool halTakeSample(int *adc) {
+  if (!newSample) return false;
+  portENTER_CRITICAL(&timerMux);
+  *adc      = rawADC;
+  takenCurrent = rawCurrent;
+  takenUs   = sampleUs;
+  takenSeq  = sampleSeq;
+  newSample = false;
+  portEXIT_CRITICAL(&timerMux);
+  return true;
 }
 
-// ===================================================
-//  PROCESS EMG
-// ===================================================
-void processEMG(int adc) {
-  float v  = (adc / ADC_MAX) * VREF - MIDPOINT;
-  float hp = highPass(v);
-  float lp = lowPass(hp);
-  rmsBuffer[rmsIndex] = lp;
-  rmsIndex = (rmsIndex + 1) % WINDOW_SIZE;
-  rmsValue = computeRMS();
+void halSampleStamp(unsigned long *arrivalUs, uint32_t *seq) {
+  *arrivalUs = takenUs;
+  *seq       = takenSeq;
 }
 
-// ===================================================
-//  MUSCLE DEBOUNCE
-// ===================================================
-void updateMuscle() {
-  bool raw = (rmsValue > threshold);
-  if ( raw && !musclePrev) muscleOnTime  = millis();
-  if (!raw &&  musclePrev) muscleOffTime = millis();
-  if ( raw && millis() - muscleOnTime  >= CONFIRM_MS) muscleActive = true;
-  if (!raw && millis() - muscleOffTime >= RELEASE_MS)  muscleActive = false;
-  musclePrev = raw;
+int halSampleCurrent() {
+  return takenCurrent;
 }
 
-// ===================================================
-//  HAND STATE MACHINE
-// ===================================================
-void updateHand() {
-  unsigned long now = millis();
+void halServoWrite(int ch, int angle) {
+  servos[ch].write(angle);
+}
 
-  switch (handState) {
+bool halI2cWrite(uint8_t addr, const uint8_t *data, size_t len) {
+  Wire.beginTransmission(addr);
+  Wire.write(data, len);
+  return Wire.endTransmission() == 0;
+}
 
-    case IDLE:
-      if (muscleActive) {
-        handState = CLOSING;
-        stepTimer = now;
-        Serial.println(">> IDLE -> CLOSING");
-      }
-      break;
+int halSerialRead() {
+  return Serial.available() ? Serial.read() : -1;
+}
 
-    case CLOSING:
-      if (!muscleActive) {
-        handState = OPENING;
-        stepTimer = now;
-        Serial.println(">> CLOSING -> OPENING");
-        break;
-      }
-      if (now - stepTimer >= SERVO_STEP_MS) {
-        stepTimer = now;
+int halSerialTxFree() {
+  return Serial.availableForWrite();
+}
 
-        if (servoAngle < SERVO_CLOSED) {
-          servoAngle++;
-          moveAllFingers(servoAngle);
-        } else {
-          handState = HOLDING;
-          Serial.println(">> CLOSING -> HOLDING (fully closed)");
-        }
-      }
-      break;
+void halSerialWrite(const char *data, size_t len) {
+  Serial.write((const uint8_t *)data, len);
+}
 
-    case HOLDING:
-      if (!muscleActive) {
-        handState = OPENING;
-        stepTimer = now;
-        Serial.println(">> HOLDING -> OPENING");
-        break;
-      }
-      // Just hold the angle until the muscle relaxes
-      break;
+void halPrintln(const char *s) {
+  Serial.println(s);
+}
 
-    case OPENING:
-      if (now - stepTimer >= SERVO_STEP_MS) {
-        stepTimer = now;
-        if (servoAngle > SERVO_OPEN) {
-          servoAngle--;
-          moveAllFingers(servoAngle);
-        } else {
-          servoAngle = SERVO_OPEN;
-          handState  = IDLE;
-          Serial.println(">> OPENING -> IDLE");
-        }
-      }
-      break;
-  }
+void halPrintf(const char *fmt, ...) {
+  char buf[HAL_PRINTF_MAX];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (n > 0) Serial.write((const uint8_t *)buf, n < (int)sizeof(buf) ? n : sizeof(buf) - 1);
 }
 
 // ===================================================
@@ -210,94 +120,74 @@ void updateHand() {
 // ===================================================
 void setup() {
   WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+  unsigned long setupStartUs = micros();
 
+  // TX ring buffer: telemetry frames are queued, never waited on
+  Serial.setTxBufferSize(UART_TX_BUFFER);
   Serial.begin(115200);
-  delay(500);
-
-  analogReadResolution(12);
-  analogSetAttenuation(ADC_11db);
 
-  // Servos
-  ESP32PWM::allocateTimer(0);
-  ESP32PWM::allocateTimer(1);
-  ESP32PWM::allocateTimer(2);
-  ESP32PWM::allocateTimer(3);
+  arenaInit();
+  configBegin();
+  usageBegin();
+  gripRestore();
 
-  for (int i = 0; i < 5; i++) {
-    fingers[i].setPeriodHertz(50);
-    fingers[i].attach(SERVO_PINS[i], 500, 2400);
-    fingers[i].write(SERVO_OPEN);
-  }
-  servoAngle = SERVO_OPEN;
+  // Cold boot only: give the serial monitor time to attach
+  if (!warmBoot) delay(500);
 
-  // Clean muscle state
-  muscleActive  = false;
-  musclePrev    = false;
-  muscleOnTime  = 0;
-  muscleOffTime = millis();
-  handState     = IDLE;
+  analogReadResolution(12);
+  analogSetAttenuation(ADC_11db);
 
-  // 1kHz EMG timer
+  // 1kHz EMG timer — started before servo attach so processing begins at once
   emgTimer = timerBegin(0, 80, true);
   timerAttachInterrupt(emgTimer, &onTimer, true);
-  timerAlarmWrite(emgTimer, 1000, true);
+  timerAlarmWrite(emgTimer, 1000000 / SAMPLE_RATE_HZ, true);
   timerAlarmEnable(emgTimer);
 
+  // Servos: LEDC outputs, or one I2C expander that needs no LEDC timers
+  if (ACT_BACKEND == ACT_PCA9685) {
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, ACT_I2C_HZ);
+  } else {
+    ESP32PWM::allocateTimer(0);
+    ESP32PWM::allocateTimer(1);
+    ESP32PWM::allocateTimer(2);
+    ESP32PWM::allocateTimer(3);
+    for (int i = 0; i < NUM_ACTUATORS; i++) {
+      servos[i].setPeriodHertz(50);
+      servos[i].attach(SERVO_PINS[i], ACT_PULSE_MIN_US, ACT_PULSE_MAX_US);
+    }
+  }
+  if (!actBegin(ACT_BACKEND)) Serial.println("Actuators: PCA9685 not answering");
+  forceBegin(FORCE_SENSOR);
+  // Re-anchor task releases after the slow setup
+  gripStartTasks();
+
+  if (warmBoot) {
+    Serial.printf("Warm boot: thresh %.4f angle %d (setup %lu us)\n",
+                  threshold, servoAngle, micros() - setupStartUs);
+    arenaSeal();
+    return;
+  }
+
   Serial.println("=====================================");
-  Serial.println("  5-SERVO GRIP — ESP32               ");
+  Serial.printf ("  %d-SERVO GRIP — ESP32\n", NUM_ACTUATORS);
   Serial.println("=====================================");
-  Serial.printf ("  Threshold : %.4f\n", threshold);
+  Serial.printf ("  Threshold : %.4f%s\n", threshold, calibStored ? " (stored)" : "");
   Serial.printf ("  Servo range: %d to %d deg\n", SERVO_OPEN, SERVO_CLOSED);
-  Serial.println("  o = force open  t=values");
+  Serial.println("  o = force open  t=values  u=usage  r=reset config");
+  Serial.println("  x = capture  d = dump captures  a = ADC cal  b = ADC sweep");
+  Serial.println("  f = telemetry fields  p = telemetry rate  w = decimation");
+  Serial.println("  s = tasks  m = deadlines  q = signal quality  v = servos");
+  Serial.println("  g = finger calibration ([ ] jog, n next)  i = grip force");
+  Serial.println("  e = gestures (double flex: next grip mode)  h = RAM");
   Serial.println("=====================================\n");
   Serial.println("  Ready! Flex to close, relax to open.");
+  // From here on nothing may allocate
+  arenaSeal();
 }
 
 // ===================================================
 //  LOOP
 // ===================================================
 void loop() {
-  unsigned long now = millis();
-
-  // 1. EMG
-  if (newSample) {
-    portENTER_CRITICAL(&timerMux);
-    int adc   = rawADC;
-    newSample = false;
-    portEXIT_CRITICAL(&timerMux);
-    processEMG(adc);
-  }
-
-  // 2. Muscle
-  updateMuscle();
-
-  // 3. Hand
-  updateHand();
-
-  // 4. Commands
-  if (Serial.available()) {
-    char cmd = Serial.read();
-    if (cmd == 'o') {
-      handState  = OPENING;
-      Serial.println(">> Force open");
-    }
-    if (cmd == 't') {
-      Serial.printf("RMS:%.4f  Thresh:%.4f  Muscle:%d  Angle:%d  State:%d\n",
-                    rmsValue, threshold, muscleActive,
-                    servoAngle, (int)handState);
-    }
-    // Manual threshold tuning
-    if (cmd == '+') { threshold += 0.005f; Serial.printf("Threshold -> %.4f\n", threshold); }
-    if (cmd == '-') { threshold -= 0.005f; Serial.printf("Threshold -> %.4f\n", threshold); }
-  }
-
-  // 5. TelePlot @ 50Hz
-  if (now - plotTimer >= 20) {
-    plotTimer = now;
-    Serial.printf(">rms:%.4f\n",       rmsValue);
-    Serial.printf(">threshold:%.4f\n", threshold);
-    Serial.printf(">muscle:%.1f\n",    muscleActive ? 1.0f : 0.0f);
-    Serial.printf(">angle:%.1f\n",     (float)servoAngle);
-    Serial.printf(">state:%.1f\n",     (float)handState);
-  }
-}
\ No newline at end of file
+  gripLoop();
+}
@@ -0,0 +1,81 @@
+#include <FlightRecorder.h>
+#include <GripControl.h>
+#include <SimHal.h>   // HAL for the linked control code
+#include <unity.h>
+
+// ===================================================
+//  FLIGHT RECORDER — host only (pio test -e test)
+//  Samples go straight into recorderSample(); the
+//  snapshot is read back with recorderSnapshot() and
+//  recorderDecode().
+// ===================================================
+#define LEAD_SAMPLES 2500      // before the transition, more than REC_PRE_DEFAULT
+#define FILT_VOLTS   0.125f    // exact in REC_FILT_SCALE units
+
+static int rawAt(uint32_t i) { return 1000 + (int)((i * 37) % 3000); }
+
+void setUp() {
+  simReset();
+  gripPowerOn();
+}
+void tearDown() {}
+
+// Feeds samples [from, to) at 1 kHz, ticking the encoder as the loop would
+static void feed(uint32_t from, uint32_t to, HandState state) {
+  for (uint32_t i = from; i < to; i++) {
+    recorderSample(rawAt(i), (i & 1) ? FILT_VOLTS : -FILT_VOLTS, (uint8_t)state,
+                   (unsigned long)i * 1000);
+    recorderTick();
+  }
+}
+
+// IDLE -> CLOSING: one transition snapshot, pre window before it
+static void test_transition_snapshot_round_trip() {
+  feed(0, LEAD_SAMPLES, IDLE);
+  feed(LEAD_SAMPLES, LEAD_SAMPLES + REC_POST_DEFAULT, CLOSING);
+  for (int i = 0; i < REC_POST_DEFAULT && recorderSnapshotCount() == 0; i++) recorderTick();
+
+  TEST_ASSERT_EQUAL_INT(1, recorderSnapshotCount());
+  RecSnapshot hdr;
+  const uint8_t *payload = nullptr;
+  TEST_ASSERT_TRUE(recorderSnapshot(0, &hdr, &payload));
+  TEST_ASSERT_EQUAL_INT(REC_TRIG_TRANSITION, hdr.trigger);
+  TEST_ASSERT_EQUAL_INT(0, hdr.truncated);
+  TEST_ASSERT_EQUAL_INT(REC_PRE_DEFAULT, hdr.pre);
+  TEST_ASSERT_EQUAL_INT(REC_PRE_DEFAULT + REC_POST_DEFAULT, hdr.samples);
+
+  static RecSample out[REC_PRE_DEFAULT + REC_POST_DEFAULT];
+  size_t n = recorderDecode(payload, hdr.bytes, out, REC_PRE_DEFAULT + REC_POST_DEFAULT);
+  TEST_ASSERT_EQUAL_INT(hdr.samples, (int)n);
+  uint32_t first = LEAD_SAMPLES - REC_PRE_DEFAULT;
+  int rawBad = 0, filtBad = 0;
+  for (size_t k = 0; k < n; k++) {
+    uint32_t i = first + (uint32_t)k;
+    int filt = (int)(((i & 1) ? FILT_VOLTS : -FILT_VOLTS) * REC_FILT_SCALE);
+    rawBad  += out[k].raw != rawAt(i);
+    filtBad += out[k].filt != filt;
+  }
+  TEST_ASSERT_EQUAL_INT(0, rawBad);
+  TEST_ASSERT_EQUAL_INT(0, filtBad);
+  // The trigger sample is the first of the post window
+  TEST_ASSERT_EQUAL_INT(IDLE, out[hdr.pre - 1].state & REC_STATE_MASK);
+  TEST_ASSERT_EQUAL_INT(CLOSING, out[hdr.pre].state & REC_STATE_MASK);
+}
+
+// A second transition during the post window is suppressed, not recorded
+static void test_transition_in_post_window_suppressed() {
+  feed(0, LEAD_SAMPLES, IDLE);
+  feed(LEAD_SAMPLES, LEAD_SAMPLES + 100, CLOSING);
+  feed(LEAD_SAMPLES + 100, LEAD_SAMPLES + 2 * REC_POST_DEFAULT, HOLDING);
+  for (int i = 0; i < REC_POST_DEFAULT && recorderSnapshotCount() == 0; i++) recorderTick();
+
+  TEST_ASSERT_EQUAL_INT(1, recorderSnapshotCount());
+  TEST_ASSERT_EQUAL_INT(1, (int)recorderStats().suppressed);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_transition_snapshot_round_trip);
+  RUN_TEST(test_transition_in_post_window_suppressed);
+  return UNITY_END();
+}
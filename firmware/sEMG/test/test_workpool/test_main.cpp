@@ -0,0 +1,61 @@
+#include <WorkPool.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unity.h>
+
+// ===================================================
+//  WORK POOL — host only (pio test -e test)
+// ===================================================
+#define OUTER  16
+#define INNER  32
+#define ROUNDS 50
+
+void setUp() {}
+void tearDown() {}
+
+// wait() must not return while tasks submitted from tasks still run
+// (host/tune fans candidate chunks out this way)
+static void test_nested_submit_waits_for_children() {
+  WorkPool pool(4);
+  for (int r = 0; r < ROUNDS; r++) {
+    std::atomic<int> done{0};
+    for (int i = 0; i < OUTER; i++) {
+      pool.submit([&](unsigned) {
+        for (int k = 0; k < INNER; k++)
+          pool.submit([&](unsigned) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            done++;
+          });
+      });
+    }
+    pool.wait();
+    TEST_ASSERT_EQUAL_INT(OUTER * INNER, done.load());
+  }
+}
+
+// A worker of one pool submitting to a smaller one
+static void test_submit_across_pools() {
+  for (int r = 0; r < ROUNDS; r++) {
+    WorkPool outer(4), inner(2);
+    std::atomic<int> done{0}, badWorker{0};
+    for (int i = 0; i < OUTER; i++)
+      outer.submit([&](unsigned) {
+        inner.submit([&](unsigned worker) {
+          if (worker >= inner.size()) badWorker++;
+          done++;
+        });
+      });
+    outer.wait();
+    inner.wait();
+    TEST_ASSERT_EQUAL_INT(OUTER, done.load());
+    TEST_ASSERT_EQUAL_INT(0, badWorker.load());
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nested_submit_waits_for_children);
+  RUN_TEST(test_submit_across_pools);
+  return UNITY_END();
+}